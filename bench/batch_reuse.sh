@@ -0,0 +1,68 @@
+#!/bin/bash
+# Checks that workers reused for several inputs write every class under its
+# own name.
+#
+# Usage: bench/batch_reuse.sh <PhpClassBuilder executable> [models] [threads...]
+# Writes <models> input classes (200 by default) with names of different
+# lengths into a temporary directory and generates them with a -d run for
+# every thread count given (1 2 4 by default), so each worker handles many
+# files. Every other input starts with a comment of a few pages, so a class
+# name left over from it points past the end of the next, smaller mapping.
+# Every input must give <name>.php declaring that class, and nothing else
+# may be written.
+BUILDER=${1:?usage: bench/batch_reuse.sh <PhpClassBuilder executable> [models] [threads...]}
+BUILDER=$(cd "$(dirname "$BUILDER")" && pwd)/$(basename "$BUILDER")
+MODELS=${2:-200}
+shift
+[ $# -gt 0 ] && shift
+THREADS=${*:-1 2 4}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+mkdir -p "$WORK/in"
+for ((i = 0; i < MODELS; i++)); do
+    name=Model$i$(head -c $((i % 50)) /dev/zero | tr '\0' 'x')
+    {
+        echo "<?php"
+        if ((i % 2 == 0)); then
+            for ((l = 0; l < 200; l++)); do
+                echo "    // padding line $l of a comment that moves the class past the first pages"
+            done
+        fi
+        echo "    Class $name{"
+        echo "        public \$ID;"
+        for ((f = 0; f < 1 + i % 8; f++)); do
+            echo "        public \$Field$f;"
+        done
+        echo "        private \$conn;"
+        echo "        private \$table_name = \"Models$i\";"
+        echo "    }"
+        echo "?>"
+    } > "$WORK/in/$name.php"
+done
+
+failures=0
+printf "%-8s %8s %s\n" threads outputs result
+for j in $THREADS; do
+    rm -rf "$WORK/out"
+    result=ok
+    "$BUILDER" -d "$WORK/in" -o "$WORK/out" -j "$j" > "$WORK/log" 2>&1
+    status=$?
+    if [ "$status" -ne 0 ]; then
+        result="exited with status $status"
+    else
+        for input in "$WORK"/in/*.php; do
+            name=$(basename "$input" .php)
+            if ! grep -q "class $name\$" "$WORK/out/$name.php" 2> /dev/null; then
+                result="$name.php missing or wrong"
+                break
+            fi
+        done
+    fi
+    outputs=$(find "$WORK/out" -name '*.php' 2> /dev/null | wc -l)
+    [ "$result" = ok ] && [ "$outputs" -ne "$MODELS" ] && result="$outputs outputs for $MODELS inputs"
+    [ "$result" = ok ] || failures=$((failures + 1))
+    printf "%-8s %8s %s\n" "$j" "$outputs" "$result"
+done
+[ "$failures" -eq 0 ]
@@ -0,0 +1,89 @@
+#!/bin/bash
+# Checks and times the wrapping of generated method comments.
+#
+# Usage: bench/comment_wrap.sh <PhpClassBuilder executable> [lengths...]
+# The class name is repeated throughout the method descriptions, so a long
+# class name gives long descriptions with a long unbreakable word in them.
+# A class is generated and timed for every name length given (10 60 120 240
+# by default; the output file name limits it to 250), then FUZZ classes (200
+# by default) with names of random lengths are generated. Every method
+# comment line must be at most 70 characters unless it is a single word.
+BUILDER=${1:?usage: bench/comment_wrap.sh <PhpClassBuilder executable> [lengths...]}
+BUILDER=$(cd "$(dirname "$BUILDER")" && pwd)/$(basename "$BUILDER")
+shift
+LENGTHS=${@:-10 60 120 240}
+FUZZ=${FUZZ:-200}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+# Writes an input class whose name is $1
+writeInput()
+{
+    {
+        echo "<?php"
+        echo "    Class Wrap{"
+        echo "        public \$ID;"
+        echo "        public \$Name;"
+        echo "        private \$conn;"
+        echo "        private \$table_name = \"Wraps\";"
+        echo "    }"
+        echo "?>"
+    } | sed "s/Class Wrap{/Class $1{/" > input.php
+}
+
+# Checks the comments of the class generated from input.php for the class
+# name $1 and prints ok or the problem found
+checkOutput()
+{
+    local output="$1.php"
+    if [ ! -f "$output" ]; then
+        echo "no output"
+        return
+    fi
+    # description lines of method comments must fit in 70 characters
+    # or be a single word; the class comment is not wrapped
+    local long
+    long=$(grep -a $'^\t \\* ' "$output" | grep -av -e '@param' -e '@return' -e 'Class used to' \
+           | sed 's/^\t \* //' | awk 'length($0) > 70 && index($0, " ") > 0' | wc -l)
+    rm -f "$output"
+    if [ "$long" -ne 0 ]; then
+        echo "$long lines over 70 characters"
+    else
+        echo ok
+    fi
+}
+
+failures=0
+printf "%-8s %-8s %10s %s\n" length kind seconds result
+for length in $LENGTHS; do
+    name=$(head -c "$length" /dev/zero | tr '\0' 'w')
+    writeInput "$name"
+    start=$(date +%s.%N)
+    "$BUILDER" -l input.php > /dev/null 2>&1
+    end=$(date +%s.%N)
+    result=$(checkOutput "$name")
+    [ "$result" = ok ] || failures=$((failures + 1))
+    awk -v l="$length" -v s="$start" -v e="$end" -v r="$result" \
+        'BEGIN { printf "%-8s %-8s %10.3f %s\n", l, "word", e - s, r }'
+done
+
+# class names of random lengths move every break to a different position
+fuzzFailures=0
+start=$(date +%s.%N)
+for ((i = 0; i < FUZZ; i++)); do
+    name=W$(head -c 256 /dev/urandom | tr -dc 'a-z' | head -c $((RANDOM % 120)))
+    writeInput "$name"
+    "$BUILDER" -l input.php > /dev/null 2>&1
+    result=$(checkOutput "$name")
+    if [ "$result" != ok ]; then
+        echo "class name $name: $result"
+        fuzzFailures=$((fuzzFailures + 1))
+    fi
+done
+end=$(date +%s.%N)
+failures=$((failures + fuzzFailures))
+awk -v n="$FUZZ" -v s="$start" -v e="$end" -v f="$fuzzFailures" \
+    'BEGIN { printf "%-8s %-8s %10.3f %d failed\n", n, "fuzz", e - s, f }'
+exit $((failures > 0))
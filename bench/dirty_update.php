@@ -0,0 +1,124 @@
+<?php
+/*
+ * Compares update on objects read with readOne, which only writes the
+ * columns changed since, with update on objects that were not read, which
+ * writes every column, on a local SQLite database.
+ *
+ * Usage: php bench/dirty_update.php <PhpClassBuilder executable> [rows] [fields]
+ * Generates a Wide class with <fields> integer properties (20 by default),
+ * fills a temporary SQLite database with <rows> records (10000 by default)
+ * and changes one field of every record both ways. readOne must load each
+ * record, and a column changed by someone else between readOne and update
+ * must be kept, as update only writes what the object changed.
+ * Requires the pdo_sqlite extension.
+ */
+if($argc < 2)
+{
+    fwrite(STDERR, "usage: php bench/dirty_update.php <PhpClassBuilder executable> [rows] [fields]\n");
+    exit(1);
+}
+$builder = realpath($argv[1]);
+$rows = isset($argv[2]) ? (int)$argv[2] : 10000;
+$fields = isset($argv[3]) ? max(2, (int)$argv[3]) : 20;
+
+$work = sys_get_temp_dir() . "/dirty_update_" . getmypid();
+mkdir($work);
+register_shutdown_function(function() use ($work)
+{
+    array_map('unlink', glob("$work/*"));
+    rmdir($work);
+});
+
+$columns = [];
+for($f = 0; $f < $fields; $f++)
+{
+    $columns[] = "Field$f";
+}
+$properties = "";
+foreach($columns as $column)
+{
+    $properties .= "        public \$$column;\n";
+}
+file_put_contents("$work/Wide.in.php",
+    "<?php\n"
+    . "    class Wide{\n"
+    . "        public \$ID;\n"
+    . $properties
+    . "        private \$conn;\n"
+    . "        private \$table_name = \"Wides\";\n"
+    . "    }\n"
+    . "?>");
+exec("cd " . escapeshellarg($work) . " && " . escapeshellarg($builder) . " -l Wide.in.php", $output, $status);
+if($status != 0 || !file_exists("$work/Wide.php"))
+{
+    fwrite(STDERR, "generating Wide failed\n");
+    exit(1);
+}
+require "$work/Wide.php";
+
+$db = new PDO("sqlite:$work/wides.db");
+$db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+$db->exec("CREATE TABLE Wides (ID INTEGER PRIMARY KEY, " . implode(" INTEGER, ", $columns) . " INTEGER)");
+echo "Inserting $rows rows\n";
+$db->beginTransaction();
+$insert = $db->prepare("INSERT INTO Wides (ID, " . implode(", ", $columns) . ") VALUES (?" . str_repeat(", ?", $fields) . ")");
+for($i = 1; $i <= $rows; $i++)
+{
+    $insert->execute(array_merge([$i], array_fill(0, $fields, $i)));
+}
+$db->commit();
+
+//without a snapshot every column is written
+$db->beginTransaction();
+$start = hrtime(true);
+for($i = 1; $i <= $rows; $i++)
+{
+    $object = new Wide($db);
+    foreach($columns as $column)
+    {
+        $object->$column = $i;
+    }
+    $object->Field0 = $i + 1;
+    $object->update($i);
+}
+$fullMs = (hrtime(true) - $start) / 1e6;
+$db->commit();
+
+//readOne takes the snapshot, so update only writes Field0
+$db->beginTransaction();
+$start = hrtime(true);
+for($i = 1; $i <= $rows; $i++)
+{
+    $object = new Wide($db);
+    $object->ID = $i;
+    $object->readOne();
+    if($object->Field1 === null)
+    {
+        $db->rollBack();
+        fwrite(STDERR, "readOne did not load record $i\n");
+        exit(1);
+    }
+    $object->Field0 = $i + 2;
+    $object->update($i);
+}
+$dirtyMs = (hrtime(true) - $start) / 1e6;
+$db->commit();
+
+printf("%-16s %12s %14s\n", "update", "ms", "records/s");
+printf("%-16s %12.3f %14.0f\n", "every column", $fullMs, $rows / ($fullMs / 1000));
+printf("%-16s %12.3f %14.0f\n", "readOne, dirty", $dirtyMs, $rows / ($dirtyMs / 1000));
+
+//a column changed by someone else after readOne must survive update
+$object = new Wide($db);
+$object->ID = 1;
+$object->readOne();
+$db->exec("UPDATE Wides SET Field1 = -1 WHERE ID = 1");
+$object->Field0 = 0;
+$object->update(1);
+$row = $db->query("SELECT Field0, Field1 FROM Wides WHERE ID = 1")->fetch(PDO::FETCH_ASSOC);
+if($row['Field0'] != 0 || $row['Field1'] != -1)
+{
+    fwrite(STDERR, "update wrote columns the object did not change\n");
+    exit(1);
+}
+?>
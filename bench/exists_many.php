@@ -0,0 +1,101 @@
+<?php
+/*
+ * Compares the generated existsMany method with calling checkIfExists once
+ * per object on a local SQLite database.
+ *
+ * Usage: php bench/exists_many.php <PhpClassBuilder executable> [rows] [candidates] [chunk]
+ * Generates a Pair class, fills a temporary SQLite database with <rows>
+ * records (100000 by default) indexed on their fields, and checks
+ * <candidates> objects (10000 by default), half of them stored and half
+ * not, with checkIfExists per object and with existsMany in batches of
+ * <chunk> (500 by default). checkIfExists also compares ID, so stored
+ * candidates carry the ID of their record. Both must find the same objects.
+ * Requires the pdo_sqlite extension.
+ */
+if($argc < 2)
+{
+    fwrite(STDERR, "usage: php bench/exists_many.php <PhpClassBuilder executable> [rows] [candidates] [chunk]\n");
+    exit(1);
+}
+$builder = realpath($argv[1]);
+$rows = isset($argv[2]) ? (int)$argv[2] : 100000;
+$candidates = isset($argv[3]) ? (int)$argv[3] : 10000;
+$chunk = isset($argv[4]) ? (int)$argv[4] : 500;
+
+$work = sys_get_temp_dir() . "/exists_many_" . getmypid();
+mkdir($work);
+register_shutdown_function(function() use ($work)
+{
+    array_map('unlink', glob("$work/*"));
+    rmdir($work);
+});
+
+//checkIfExists inlines its values unquoted, so the fields are integers
+file_put_contents("$work/Pair.in.php",
+    "<?php\n"
+    . "    class Pair{\n"
+    . "        public \$ID;\n"
+    . "        public \$Source;\n"
+    . "        public \$Target;\n"
+    . "        private \$conn;\n"
+    . "        private \$table_name = \"Pairs\";\n"
+    . "    }\n"
+    . "?>");
+exec("cd " . escapeshellarg($work) . " && " . escapeshellarg($builder) . " -l Pair.in.php", $output, $status);
+if($status != 0 || !file_exists("$work/Pair.php"))
+{
+    fwrite(STDERR, "generating Pair failed\n");
+    exit(1);
+}
+require "$work/Pair.php";
+
+$db = new PDO("sqlite:$work/pairs.db");
+$db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+$db->exec("CREATE TABLE Pairs (ID INTEGER PRIMARY KEY, Source INTEGER, Target INTEGER)");
+$db->exec("CREATE INDEX PairsFields ON Pairs (Source, Target)");
+echo "Inserting $rows rows\n";
+$db->beginTransaction();
+$insert = $db->prepare("INSERT INTO Pairs (ID, Source, Target) VALUES (?, ?, ?)");
+for($i = 1; $i <= $rows; $i++)
+{
+    $insert->execute([$i, $i, $i * 7]);
+}
+$db->commit();
+$db->exec("ANALYZE");
+
+//even candidates are stored rows, odd ones are not
+mt_srand(1);
+$objects = [];
+$expected = [];
+for($i = 0; $i < $candidates; $i++)
+{
+    $object = new Pair($db);
+    $id = mt_rand(1, $rows);
+    $object->ID = $i % 2 == 0 ? $id : 0;
+    $object->Source = $id;
+    $object->Target = $i % 2 == 0 ? $id * 7 : $id * 7 + 1;
+    $objects[] = $object;
+    $expected[] = $i % 2 == 0;
+}
+
+$start = hrtime(true);
+$perRow = [];
+foreach($objects as $object)
+{
+    $perRow[] = $object->checkIfExists();
+}
+$perRowMs = (hrtime(true) - $start) / 1e6;
+
+$start = hrtime(true);
+$batched = Pair::existsMany($db, $objects, $chunk);
+$batchedMs = (hrtime(true) - $start) / 1e6;
+
+printf("%-14s %12s %14s\n", "method", "ms", "objects/s");
+printf("%-14s %12.3f %14.0f\n", "checkIfExists", $perRowMs, $candidates / ($perRowMs / 1000));
+printf("%-14s %12.3f %14.0f\n", "existsMany", $batchedMs, $candidates / ($batchedMs / 1000));
+if($perRow != $expected || $batched != $expected)
+{
+    fwrite(STDERR, "the methods disagree on which objects exist\n");
+    exit(1);
+}
+?>
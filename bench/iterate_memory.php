@@ -0,0 +1,118 @@
+<?php
+/*
+ * Checks that the generated iterate method keeps memory flat while walking a
+ * large table, and compares it with fetching every row from read().
+ *
+ * Usage: php bench/iterate_memory.php <PhpClassBuilder executable> [rows] [batch]
+ * Generates a Record class, fills a temporary SQLite database with <rows>
+ * records (1000000 by default) and iterates over all of them with new
+ * objects and with one reused object, reading <batch> rows per query (1000
+ * by default). Memory is sampled every 100000 rows; a run fails if it grows
+ * by more than 1 MB after the first page or if any row is missed. The peak
+ * memory of read()->fetchAll() over the same table is printed for
+ * comparison. Requires the pdo_sqlite extension.
+ */
+if($argc < 2)
+{
+    fwrite(STDERR, "usage: php bench/iterate_memory.php <PhpClassBuilder executable> [rows] [batch]\n");
+    exit(1);
+}
+$builder = realpath($argv[1]);
+$rows = isset($argv[2]) ? (int)$argv[2] : 1000000;
+$batch = isset($argv[3]) ? (int)$argv[3] : 1000;
+$sampleEvery = 100000;
+$allowedGrowth = 1024 * 1024;
+
+$work = sys_get_temp_dir() . "/iterate_memory_" . getmypid();
+mkdir($work);
+register_shutdown_function(function() use ($work)
+{
+    array_map('unlink', glob("$work/*"));
+    rmdir($work);
+});
+
+file_put_contents("$work/Record.in.php",
+    "<?php\n"
+    . "    class Record{\n"
+    . "        public \$ID;\n"
+    . "        public \$Category;\n"
+    . "        public \$Name;\n"
+    . "        private \$conn;\n"
+    . "        private \$table_name = \"Records\";\n"
+    . "    }\n"
+    . "?>");
+exec("cd " . escapeshellarg($work) . " && " . escapeshellarg($builder) . " -l Record.in.php", $output, $status);
+if($status != 0 || !file_exists("$work/Record.php"))
+{
+    fwrite(STDERR, "generating Record failed\n");
+    exit(1);
+}
+require "$work/Record.php";
+
+$db = new PDO("sqlite:$work/records.db");
+$db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+$db->exec("CREATE TABLE Records (ID INTEGER PRIMARY KEY, Category INTEGER, Name TEXT)");
+echo "Inserting $rows rows\n";
+$db->beginTransaction();
+$insert = $db->prepare("INSERT INTO Records (ID, Category, Name) VALUES (?, ?, ?)");
+for($i = 1; $i <= $rows; $i++)
+{
+    $insert->execute([$i, $i % 1000, "record $i"]);
+}
+$db->commit();
+$insert = null;
+
+$record = new Record($db);
+$failures = 0;
+printf("%-8s %10s %14s %14s %14s\n", "mode", "seconds", "first page KB", "last sample KB", "growth KB");
+foreach(["new" => false, "reuse" => true] as $mode => $reuse)
+{
+    gc_collect_cycles();
+    $start = hrtime(true);
+    $count = 0;
+    $lastId = 0;
+    $baseline = null;
+    $latest = 0;
+    foreach($record->iterate($batch, $reuse) as $object)
+    {
+        $count++;
+        if($object->ID != $lastId + 1)
+        {
+            fwrite(STDERR, "$mode: expected ID " . ($lastId + 1) . " but got {$object->ID}\n");
+            $failures++;
+            break;
+        }
+        $lastId = $object->ID;
+        //the first page allocates the statement and objects the rest reuse
+        if($count == $batch)
+        {
+            $baseline = memory_get_usage();
+        }
+        if($count % $sampleEvery == 0)
+        {
+            $latest = memory_get_usage();
+        }
+    }
+    $seconds = (hrtime(true) - $start) / 1e9;
+    $baseline = $baseline ?? memory_get_usage();
+    $growth = max($latest - $baseline, 0);
+    printf("%-8s %10.3f %14.1f %14.1f %14.1f\n", $mode, $seconds, $baseline / 1024, $latest / 1024, $growth / 1024);
+    if($count != $rows)
+    {
+        fwrite(STDERR, "$mode: iterated $count of $rows rows\n");
+        $failures++;
+    }
+    if($growth > $allowedGrowth)
+    {
+        fwrite(STDERR, "$mode: memory grew by " . round($growth / 1024) . " KB\n");
+        $failures++;
+    }
+}
+
+//the whole result set held at once, for comparison
+$before = memory_get_usage();
+$all = $record->read()->fetchAll(PDO::FETCH_ASSOC);
+printf("fetchAll of %d rows used %.1f KB\n", count($all), (memory_get_usage() - $before) / 1024);
+$all = null;
+exit($failures > 0 ? 1 : 0);
+?>
@@ -0,0 +1,136 @@
+<?php
+/*
+ * Compares deep page latency of the generated readPaging (LIMIT offset)
+ * and readAfter (keyset) methods on a local SQLite database.
+ *
+ * Usage: php bench/keyset_paging.php <PhpClassBuilder executable> [rows] [page size]
+ * Generates two classes over one Records table, RecordById without a
+ * sort_key and RecordByCategory with a sort_key of Category, fills a temporary
+ * SQLite database with <rows> records (1000000 by default) and, for pages
+ * at growing depths, times readPaging against readAfter sorted by ID and
+ * readAfter sorted by Category and ID. Every readAfter page is checked
+ * against the rows the same ORDER BY returns with an offset. Requires the
+ * pdo_sqlite extension.
+ */
+if($argc < 2)
+{
+    fwrite(STDERR, "usage: php bench/keyset_paging.php <PhpClassBuilder executable> [rows] [page size]\n");
+    exit(1);
+}
+$builder = realpath($argv[1]);
+$rows = isset($argv[2]) ? (int)$argv[2] : 1000000;
+$pageSize = isset($argv[3]) ? (int)$argv[3] : 100;
+$repeats = 5;
+
+$work = sys_get_temp_dir() . "/keyset_paging_" . getmypid();
+mkdir($work);
+register_shutdown_function(function() use ($work)
+{
+    array_map('unlink', glob("$work/*"));
+    rmdir($work);
+});
+
+//two classes over the same table, one paging by ID and one by Category, ID
+$models = [
+    "RecordById" => "",
+    "RecordByCategory" => "        private \$sort_key = \"Category\";\n",
+];
+foreach($models as $name => $sortKey)
+{
+    file_put_contents("$work/$name.in.php",
+        "<?php\n"
+        . "    class $name{\n"
+        . "        public \$ID;\n"
+        . "        public \$Category;\n"
+        . "        public \$Name;\n"
+        . "        private \$conn;\n"
+        . "        private \$table_name = \"Records\";\n"
+        . $sortKey
+        . "    }\n"
+        . "?>");
+    exec("cd " . escapeshellarg($work) . " && " . escapeshellarg($builder) . " -l $name.in.php", $output, $status);
+    if($status != 0 || !file_exists("$work/$name.php"))
+    {
+        fwrite(STDERR, "generating $name failed\n");
+        exit(1);
+    }
+    require "$work/$name.php";
+}
+
+$db = new PDO("sqlite:$work/records.db");
+$db->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+$db->exec("CREATE TABLE Records (ID INTEGER PRIMARY KEY, Category INTEGER, Name TEXT)");
+$db->exec("CREATE INDEX RecordsCategory ON Records (Category, ID)");
+echo "Inserting $rows rows\n";
+$db->beginTransaction();
+$insert = $db->prepare("INSERT INTO Records (ID, Category, Name) VALUES (?, ?, ?)");
+mt_srand(1);
+for($i = 1; $i <= $rows; $i++)
+{
+    $insert->execute([$i, mt_rand(0, 999), "record $i"]);
+}
+$db->commit();
+$db->exec("ANALYZE");
+
+/**
+ * Runs a callable $repeats times and returns the fastest run in milliseconds
+ * along with its result
+ */
+function fastest(callable $run, int $repeats) : array
+{
+    $best = INF;
+    $result = null;
+    for($r = 0; $r < $repeats; $r++)
+    {
+        $start = hrtime(true);
+        $result = $run();
+        $best = min($best, (hrtime(true) - $start) / 1e6);
+    }
+    return [$best, $result];
+}
+
+$byId = new RecordById($db);
+$byCategory = new RecordByCategory($db);
+printf("%-10s %14s %14s %18s %18s\n", "offset", "ID offset ms", "ID keyset ms", "Category offset ms", "Category keyset ms");
+for($offset = 0; $offset + $pageSize <= $rows; $offset = $offset == 0 ? 1000 : $offset * 10)
+{
+    //readPaging skips $offset rows; readAfter seeks to the row before the page
+    [$pagingMs, $expected] = fastest(function() use ($byId, $offset, $pageSize)
+    {
+        return $byId->readPaging($offset, $pageSize)->fetchAll(PDO::FETCH_ASSOC);
+    }, $repeats);
+    $lastId = $offset == 0 ? null : $expected[0]['ID'] - 1;
+    [$afterMs, $page] = fastest(function() use ($byId, $lastId, $pageSize)
+    {
+        return $byId->readAfter($lastId, $pageSize)->fetchAll(PDO::FETCH_ASSOC);
+    }, $repeats);
+    if($page != $expected)
+    {
+        fwrite(STDERR, "readAfter by ID returned a different page at offset $offset\n");
+        exit(1);
+    }
+
+    //the same comparison ordered by Category, ID
+    $query = "SELECT * FROM Records ORDER BY Category ASC, ID ASC LIMIT ?, ?";
+    [$offsetMs, $expected] = fastest(function() use ($db, $query, $offset, $pageSize)
+    {
+        $stmt = $db->prepare($query);
+        $stmt->bindValue(1, max($offset - 1, 0), PDO::PARAM_INT);
+        $stmt->bindValue(2, $pageSize + 1, PDO::PARAM_INT);
+        $stmt->execute();
+        return $stmt->fetchAll(PDO::FETCH_ASSOC);
+    }, $repeats);
+    $lastKey = $offset == 0 ? null : array_shift($expected);
+    $expected = array_slice($expected, 0, $pageSize);
+    [$keysetMs, $page] = fastest(function() use ($byCategory, $lastKey, $pageSize)
+    {
+        return $byCategory->readAfter($lastKey, $pageSize)->fetchAll(PDO::FETCH_ASSOC);
+    }, $repeats);
+    if($page != $expected)
+    {
+        fwrite(STDERR, "readAfter by Category returned a different page at offset $offset\n");
+        exit(1);
+    }
+    printf("%-10d %14.3f %14.3f %18.3f %18.3f\n", $offset, $pagingMs, $afterMs, $offsetMs, $keysetMs);
+}
+?>
@@ -0,0 +1,44 @@
+#!/bin/bash
+# Measures how batch generation scales with -j on a synthetic corpus.
+#
+# Usage: bench/scaling.sh <PhpClassBuilder executable> [models] [threads...]
+# Writes <models> generated input classes (10000 by default) with 5 to 40
+# properties each into a temporary directory, then times a full -d -r run
+# for every thread count given (1 2 4 8 auto by default).
+BUILDER=${1:?usage: bench/scaling.sh <PhpClassBuilder executable> [models] [threads...]}
+BUILDER=$(cd "$(dirname "$BUILDER")" && pwd)/$(basename "$BUILDER")
+MODELS=${2:-10000}
+shift
+[ $# -gt 0 ] && shift
+THREADS=${*:-1 2 4 8 auto}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "Writing $MODELS models to $WORK/in"
+for ((i = 0; i < MODELS; i++)); do
+    dir="$WORK/in/group$((i % 100))"
+    mkdir -p "$dir"
+    {
+        echo "<?php"
+        echo "    Class Model$i{"
+        echo "        public \$ID;"
+        for ((f = 0; f < 5 + i % 36; f++)); do
+            echo "        public \$Field$f;"
+        done
+        echo "        private \$conn;"
+        echo "        private \$table_name = \"Models$i\";"
+        echo "    }"
+        echo "?>"
+    } > "$dir/Model$i.php"
+done
+
+printf "%-8s %10s %12s\n" threads seconds models/s
+for j in $THREADS; do
+    rm -rf "$WORK/out"
+    start=$(date +%s.%N)
+    "$BUILDER" -d "$WORK/in" -r -o "$WORK/out" -j "$j" > /dev/null || echo "run with -j $j failed"
+    end=$(date +%s.%N)
+    awk -v j="$j" -v s="$start" -v e="$end" -v n="$MODELS" \
+        'BEGIN { printf "%-8s %10.3f %12.0f\n", j, e - s, n / (e - s) }'
+done
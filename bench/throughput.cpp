@@ -0,0 +1,401 @@
+/*********************************************************************************
+ * PHPClass Builder throughput benchmark
+ *
+ * Writes a synthetic corpus of input classes and measures how fast they are
+ * parsed, rendered and written. Results are printed as a table and saved as
+ * JSON so runs of different releases can be compared.
+ *
+ *  ******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "MappedFile.h"
+#include "PHPBuilder.h"
+#include "PHPParser.h"
+
+/**
+ * Size of one benchmark run: the properties of every
+ * input class and the number of input files
+ */
+struct Scenario
+{
+    size_t properties; /**< Public properties of each class besides ID */
+    size_t files; /**< Number of input files */
+};
+
+/**
+ * Measurements of one phase of a scenario
+ */
+struct PhaseResult
+{
+    double seconds = 0; /**< Time spent in the phase */
+    size_t bytes = 0; /**< Bytes read by parse, rendered by emit or written by write */
+    long peakRssKb = 0; /**< Highest resident set size during the phase */
+};
+
+/**
+ * Measurements of one scenario
+ */
+struct ScenarioResult
+{
+    Scenario scenario; /**< Size of the run */
+    PhaseResult parse; /**< Mapping and parsing every input */
+    PhaseResult emit; /**< Rendering every class into memory */
+    PhaseResult write; /**< Rendering and writing every class to disk */
+    size_t diagnostics = 0; /**< Problems reported by the parser, expected to be 0 */
+};
+
+bool parseScenarios(std::vector<std::string> &arguments, std::vector<Scenario> &scenarios);
+size_t writeCorpus(const std::filesystem::path &directory, const Scenario &scenario);
+void resetPeakRss();
+long getPeakRssKb();
+bool runScenario(const Scenario &scenario, const std::filesystem::path &work, ScenarioResult &result);
+void printResult(const ScenarioResult &result);
+void writePhase(std::ostream &out, std::string_view name, const PhaseResult &phase, size_t files, bool last);
+bool writeJson(const std::string &fileName, const std::vector<ScenarioResult> &results);
+
+/**
+ * Runs every scenario given with -s, or a default set
+ * covering small to very wide classes, and saves the
+ * results to the file given with --json
+ * (throughput.json by default). With --corpus the
+ * inputs of the first scenario are written to that
+ * directory and kept instead of being benchmarked.
+ * @param argc integer for total number of arguments
+ * @param argv a character array of arguments
+ * @return int
+ */
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    std::vector<Scenario> scenarios;
+    if(!parseScenarios(arguments, scenarios))
+    {
+        std::cout << "usage: PhpClassBuilderBench [-s PROPERTIESxFILES]... [--json FILE] [--corpus DIRECTORY]\n";
+        return 1;
+    }
+    std::string jsonFile = "throughput.json";
+    std::string corpus;
+    for(size_t i = 0; i + 1 < arguments.size(); i++)
+    {
+        if(arguments[i] == "--json"){jsonFile = arguments[i + 1];}
+        if(arguments[i] == "--corpus"){corpus = arguments[i + 1];}
+    }
+
+    std::error_code error;
+    if(!corpus.empty())
+    {
+        std::filesystem::create_directories(corpus, error);
+        size_t bytes = writeCorpus(corpus, scenarios[0]);
+        std::cout << "Wrote " << scenarios[0].files << " inputs, " << bytes << " bytes, to " << corpus << "\n";
+        return bytes > 0 ? 0 : 1;
+    }
+
+    std::filesystem::path work = std::filesystem::temp_directory_path()
+                                 / ("phpclassbuilder_bench_" + std::to_string(getpid()));
+    std::vector<ScenarioResult> results;
+    std::printf("%-12s %8s %10s %12s %12s %14s %10s %10s %10s\n", "properties", "files", "parse MB/s",
+                "emit cls/s", "write cls/s", "emit bytes/s", "parse KB", "emit KB", "write KB");
+    bool ok = true;
+    for(const Scenario &scenario : scenarios)
+    {
+        ScenarioResult result;
+        ok = runScenario(scenario, work, result) && ok;
+        std::filesystem::remove_all(work, error);
+        printResult(result);
+        results.push_back(result);
+    }
+    if(!writeJson(jsonFile, results))
+    {
+        std::cout << "Error: " << jsonFile << " could not be written.\n";
+        return 1;
+    }
+    std::cout << "Results saved to " << jsonFile << "\n";
+    return ok ? 0 : 1;
+}
+
+/**
+ * Reads the scenarios given as -s PROPERTIESxFILES,
+ * e.g. -s 2000x100. Without any, a default set from 1
+ * to 2000 properties is used. Returns false for a
+ * malformed scenario.
+ * @param arguments vector of strings
+ * @param scenarios vector of Scenario to fill
+ * @return bool
+ */
+bool parseScenarios(std::vector<std::string> &arguments, std::vector<Scenario> &scenarios)
+{
+    for(size_t i = 0; i < arguments.size(); i++)
+    {
+        if(arguments[i] != "-s"){continue;}
+        if(i + 1 >= arguments.size()){return false;}
+        const std::string &value = arguments[i + 1];
+        size_t x = value.find('x');
+        if(x == std::string::npos){return false;}
+        try
+        {
+            Scenario scenario{std::stoul(value.substr(0, x)), std::stoul(value.substr(x + 1))};
+            if(scenario.files == 0){return false;}
+            scenarios.push_back(scenario);
+        }
+        catch(const std::exception &)
+        {
+            return false;
+        }
+    }
+    if(scenarios.empty())
+    {
+        scenarios = {{1, 10000}, {20, 10000}, {200, 1000}, {2000, 100}};
+    }
+    return true;
+}
+
+/**
+ * Writes the input classes of a scenario into a
+ * directory, 1000 files per subdirectory. Every
+ * fourth property is declared ?int and the classes
+ * page by a sort_key, so the typed and keyset paths
+ * are rendered too. Returns the number of bytes
+ * written, 0 on failure.
+ * @param directory filesystem path
+ * @param scenario Scenario
+ * @return size_t
+ */
+size_t writeCorpus(const std::filesystem::path &directory, const Scenario &scenario)
+{
+    size_t total = 0;
+    std::string text;
+    std::error_code error;
+    for(size_t i = 0; i < scenario.files; i++)
+    {
+        std::filesystem::path group = directory / ("group" + std::to_string(i / 1000));
+        if(i % 1000 == 0)
+        {
+            std::filesystem::create_directories(group, error);
+        }
+        text = "<?php\n    class Model" + std::to_string(i) + "{\n        public $ID;\n";
+        for(size_t f = 0; f < scenario.properties; f++)
+        {
+            text += f % 4 == 3 ? "        public ?int $Field" : "        public $Field";
+            text += std::to_string(f) + ";\n";
+        }
+        text += "        private $conn;\n";
+        text += "        private $table_name = \"Models" + std::to_string(i) + "\";\n";
+        if(scenario.properties > 0)
+        {
+            text += "        private $sort_key = \"Field0\";\n";
+        }
+        text += "    }\n?>";
+        std::ofstream file(group / ("Model" + std::to_string(i) + ".php"), std::ios::binary);
+        file << text;
+        if(!file)
+        {
+            return 0;
+        }
+        total += text.size();
+    }
+    return total;
+}
+
+/**
+ * Resets the peak resident set size of the process so
+ * the next phase reports its own peak. Only Linux
+ * supports this; elsewhere the peak of the whole run
+ * is reported.
+ * @return void
+ */
+void resetPeakRss()
+{
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+/**
+ * Retrieves the peak resident set size since the last
+ * resetPeakRss, in kilobytes. Falls back to getrusage,
+ * which reports the peak of the whole process.
+ * @return long
+ */
+long getPeakRssKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line))
+    {
+        if(line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::stol(line.substr(6));
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Writes the corpus of a scenario and times its phases.
+ * Parse maps and parses every input. Emit parses
+ * each input again and renders its class into memory,
+ * timing only the rendering. Write runs
+ * createClassFile, rendering and writing every class.
+ * Returns false if an input could not be read or an
+ * output could not be written.
+ * @param scenario Scenario
+ * @param work filesystem path of a scratch directory
+ * @param result ScenarioResult to fill
+ * @return bool
+ */
+bool runScenario(const Scenario &scenario, const std::filesystem::path &work, ScenarioResult &result)
+{
+    using Clock = std::chrono::steady_clock;
+    result.scenario = scenario;
+    std::error_code error;
+    std::filesystem::path input = work / "in";
+    std::filesystem::path output = work / "out";
+    std::filesystem::create_directories(input, error);
+    std::filesystem::create_directories(output, error);
+    if(writeCorpus(input, scenario) == 0)
+    {
+        std::cout << "Error: the corpus could not be written to " << input << "\n";
+        return false;
+    }
+    std::vector<std::string> files;
+    for(const auto &entry : std::filesystem::recursive_directory_iterator(input))
+    {
+        if(entry.is_regular_file()){files.push_back(entry.path().string());}
+    }
+
+    PHPParser parser;
+    PHPBuilder builder;
+    builder.setLog(nullptr);
+    builder.setOutputDirectory(output.string());
+
+    resetPeakRss();
+    Clock::time_point start = Clock::now();
+    for(const std::string &file : files)
+    {
+        MappedFile mapped(file);
+        if(!mapped.isOpen()){return false;}
+        parser.parse(mapped.view(), builder);
+        result.parse.bytes += mapped.view().size();
+        result.diagnostics += parser.getDiagnostics().size();
+    }
+    result.parse.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.parse.peakRssKb = getPeakRssKb();
+
+    resetPeakRss();
+    for(const std::string &file : files)
+    {
+        MappedFile mapped(file);
+        if(!mapped.isOpen()){return false;}
+        parser.parse(mapped.view(), builder);
+        start = Clock::now();
+        builder.renderClass();
+        result.emit.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        result.emit.bytes += builder.getOutput().size();
+    }
+    result.emit.peakRssKb = getPeakRssKb();
+
+    resetPeakRss();
+    start = Clock::now();
+    for(const std::string &file : files)
+    {
+        MappedFile mapped(file);
+        if(!mapped.isOpen()){return false;}
+        parser.parse(mapped.view(), builder);
+        if(!builder.createClassFile())
+        {
+            std::cout << "Error: " << builder.getFileName() << " could not be written.\n";
+            return false;
+        }
+        result.write.bytes += builder.getOutput().size();
+    }
+    result.write.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.write.peakRssKb = getPeakRssKb();
+    return true;
+}
+
+/**
+ * Prints one line of the results table
+ * @param result ScenarioResult
+ * @return void
+ */
+void printResult(const ScenarioResult &result)
+{
+    double files = result.scenario.files;
+    std::printf("%-12zu %8zu %10.1f %12.0f %12.0f %14.0f %10ld %10ld %10ld\n",
+                result.scenario.properties, result.scenario.files,
+                result.parse.bytes / 1e6 / result.parse.seconds,
+                files / result.emit.seconds, files / result.write.seconds,
+                result.emit.bytes / result.emit.seconds,
+                result.parse.peakRssKb, result.emit.peakRssKb, result.write.peakRssKb);
+    if(result.diagnostics > 0)
+    {
+        std::cout << "Warning: the parser reported " << result.diagnostics << " problems.\n";
+    }
+}
+
+/**
+ * Writes the JSON object of one phase
+ * @param out ostream
+ * @param name string_view of the phase
+ * @param phase PhaseResult
+ * @param files number of classes handled by the phase
+ * @param last bool, true for the last phase of a scenario
+ * @return void
+ */
+void writePhase(std::ostream &out, std::string_view name, const PhaseResult &phase, size_t files, bool last)
+{
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "        \"%.*s\": {\"seconds\": %.6f, \"bytes\": %zu, \"mb_per_s\": %.3f, "
+                  "\"classes_per_s\": %.1f, \"peak_rss_kb\": %ld}%s\n",
+                  (int)name.size(), name.data(), phase.seconds, phase.bytes,
+                  phase.seconds > 0 ? phase.bytes / 1e6 / phase.seconds : 0.0,
+                  phase.seconds > 0 ? files / phase.seconds : 0.0, phase.peakRssKb, last ? "" : ",");
+    out << line;
+}
+
+/**
+ * Saves the results with the generator version and the
+ * time of the run as JSON
+ * @param fileName string
+ * @param results vector of ScenarioResult
+ * @return bool
+ */
+bool writeJson(const std::string &fileName, const std::vector<ScenarioResult> &results)
+{
+    std::ofstream out(fileName);
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    out << "{\n";
+    out << "  \"version\": \"" << PHPBUILDER_VERSION << "\",\n";
+    out << "  \"timestamp\": \"" << timestamp << "\",\n";
+    out << "  \"scenarios\": [\n";
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const ScenarioResult &r = results[i];
+        out << "    {\n";
+        out << "      \"properties\": " << r.scenario.properties << ",\n";
+        out << "      \"files\": " << r.scenario.files << ",\n";
+        out << "      \"diagnostics\": " << r.diagnostics << ",\n";
+        out << "      \"phases\": {\n";
+        writePhase(out, "parse", r.parse, r.scenario.files, false);
+        writePhase(out, "emit", r.emit, r.scenario.files, false);
+        writePhase(out, "write", r.write, r.scenario.files, true);
+        out << "      }\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1 @@
+#include "BatchGenerator.h"
\ No newline at end of file
@@ -0,0 +1,530 @@
+#ifndef BATCHGENERATOR_H
+#define BATCHGENERATOR_H
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "GenerationCache.h"
+#include "MappedFile.h"
+#include "PHPBuilder.h"
+#include "PHPParser.h"
+#include "ThreadPool.h"
+#include "Tracer.h"
+/*******************************************************************************
+ * BatchGenerator
+ *
+ * Collects many input PHP class files from directories and list files and
+ * generates all of their classes in one process. Outputs are written to an
+ * output directory that mirrors the layout of the inputs. Inputs are spread
+ * over a ThreadPool and each worker reuses one parser and one builder for
+ * every file it handles. Console output of each file is buffered and written
+ * in one piece so lines from different files do not interleave. An input
+ * may bundle several classes; each is generated as soon as it has been
+ * parsed and gets an output of its own. When the cache is enabled, classes
+ * whose model and output are unchanged since the last run are skipped. With
+ * a Tracer set, every file, its parse and the parts of its classes are
+ * recorded as spans.
+ *
+ *******************************************************************************/
+
+/**
+ * An input file and the directory its class is written to
+ */
+struct BatchJob
+{
+    std::string input; /**< Path of the input PHP file */
+    std::string outputDirectory; /**< Directory of the generated class */
+};
+
+/**
+ * Outcome of generating one input file
+ */
+struct BatchResult
+{
+    std::string input; /**< Path of the input PHP file */
+    std::string output; /**< Paths of the generated classes, comma separated, empty if none */
+    bool success; /**< True if every class was generated or is unchanged */
+    bool skipped; /**< True if every output was already up to date */
+    std::string message; /**< Field or class count on success or the reason for failure */
+    double milliseconds; /**< Time taken to parse and generate the input */
+    size_t diagnostics = 0; /**< Problems the parser reported in the input */
+};
+
+/**
+ * Parser and builder owned by one worker thread
+ */
+struct BatchWorker
+{
+    PHPParser parser; /**< Parser reused for every input of the worker */
+    PHPBuilder builder; /**< Builder reused for every input of the worker */
+    TraceBuffer *trace = nullptr; /**< Buffer the spans of the worker are recorded into, null for none */
+};
+
+class BatchGenerator
+{
+    private:
+        std::filesystem::path outputRoot; /**< Root of the mirrored output directory */
+        std::vector<BatchJob> jobs; /**< Inputs waiting to be generated */
+        std::vector<BatchResult> results; /**< Outcome of each generated input */
+        std::mutex consoleMutex; /**< Serializes console output between workers */
+        std::vector<std::unique_ptr<BatchWorker>> workers; /**< Per-thread state kept between runs */
+        std::unique_ptr<GenerationCache> cache; /**< Manifest of earlier outputs, null if disabled */
+        bool force = false; /**< True to regenerate inputs the cache reports as up to date */
+        const PHPTemplateSet *templates = nullptr; /**< Templates shared by every builder, null for none */
+        PHPBuilderOptions options; /**< Optional parts of every generated class */
+        Tracer *tracer = nullptr; /**< Tracer handing out the buffers of the workers, null for none */
+        bool quiet = false; /**< True to print only diagnostics and failures */
+
+        /**
+         * Checks if a path has a .php extension in any case
+         * @param path filesystem path
+         * @return bool
+         */
+        static bool isPHPFile(const std::filesystem::path &path)
+        {
+            std::string extension = path.extension().string();
+            for(char &c : extension)
+            {
+                c = tolower(static_cast<unsigned char>(c));
+            }
+            return extension == ".php";
+        }
+
+        /**
+         * Queues an input file whose output is written to the
+         * output root plus the input's directory relative to base.
+         * Inputs outside of base are written to the output root.
+         * @param file filesystem path of the input
+         * @param base filesystem path the mirrored layout starts from
+         * @return void
+         */
+        void addJob(const std::filesystem::path &file, const std::filesystem::path &base)
+        {
+            std::filesystem::path relative = file.parent_path().lexically_normal().lexically_relative(base.lexically_normal());
+            std::filesystem::path outputDirectory = this->outputRoot;
+            if(!relative.empty() && *relative.begin() != ".." && relative != ".")
+            {
+                outputDirectory /= relative;
+            }
+            this->jobs.push_back({file.string(), outputDirectory.string()});
+        }
+
+        /**
+         * Generates one input file with generateFile and
+         * records how long it took, also as a span named
+         * after the input if the worker traces
+         * @param job BatchJob
+         * @param worker BatchWorker of the calling thread
+         * @param log ostream progress and diagnostics are written to
+         * @return BatchResult
+         */
+        BatchResult generate(const BatchJob &job, BatchWorker &worker, std::ostream &log)
+        {
+            auto start = std::chrono::steady_clock::now();
+            int64_t traceStart = worker.trace != nullptr ? worker.trace->now() : 0;
+            BatchResult result = this->generateFile(job, worker, log);
+            if(worker.trace != nullptr){worker.trace->add(job.input, "file", traceStart);}
+            result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        }
+
+        /**
+         * Generates the class a builder has been loaded with,
+         * unless the cache reports it as up to date. Returns
+         * false if the class could not be written.
+         * @param php PHPBuilder loaded with the model
+         * @param key string naming the class in the cache
+         * @param skipped bool set to true if the class was up to date
+         * @return bool
+         */
+        bool generateClass(PHPBuilder &php, const std::string &key, bool &skipped)
+        {
+            uint64_t hash = php.getModelHash();
+            skipped = this->cache && !this->force && this->cache->isUpToDate(key, hash, php.getFileName());
+            if(skipped)
+            {
+                return true;
+            }
+            if(!php.createClassFile())
+            {
+                return false;
+            }
+            if(this->cache)
+            {
+                this->cache->record(key, hash, php.getFileName());
+            }
+            return true;
+        }
+
+        /**
+         * Parses one input file and generates each of its
+         * classes as soon as its closing brace has been read
+         * @param job BatchJob
+         * @param worker BatchWorker of the calling thread
+         * @param log ostream progress and diagnostics are written to
+         * @return BatchResult
+         */
+        BatchResult generateFile(const BatchJob &job, BatchWorker &worker, std::ostream &log)
+        {
+            BatchResult result = {job.input, "", false, false, "", 0};
+            MappedFile input(job.input);
+            if(!input.isOpen())
+            {
+                result.message = "could not be opened";
+                return result;
+            }
+            worker.builder.setOutputDirectory(job.outputDirectory);
+            worker.builder.setLog(nullptr);
+            worker.builder.setTrace(worker.trace);
+            worker.builder.setTemplates(this->templates);
+            worker.builder.setOptions(this->options);
+            worker.parser.setTrace(worker.trace);
+            auto printDiagnostics = [&]()
+            {
+                for(const PHPDiagnostic &d : worker.parser.getDiagnostics())
+                {
+                    log << job.input << ":" << d.line << ":" << d.column << ": " << d.message << "\n";
+                }
+                result.diagnostics += worker.parser.getDiagnostics().size();
+            };
+            size_t classes = 0;
+            size_t unchanged = 0;
+            std::string failures;
+            //the builder points into the mapping until each class is written
+            worker.parser.parse(input.view(), worker.builder, [&](PHPBuilder &php)
+            {
+                printDiagnostics();
+                if(classes++ == 0)
+                {
+                    std::error_code error;
+                    std::filesystem::create_directories(job.outputDirectory, error);
+                }
+                //keyed by name so reordering the classes of a bundle keeps their entries
+                std::string key = job.input + "#" + std::string(php.getClassName());
+                bool skipped = false;
+                if(!this->generateClass(php, key, skipped))
+                {
+                    failures += (failures.empty() ? "" : "; ") + php.getFileName() + " could not be written";
+                    return;
+                }
+                unchanged += skipped;
+                result.output += (result.output.empty() ? "" : ", ") + php.getFileName();
+                if(classes == 1)
+                {
+                    result.message = skipped ? "unchanged" : std::to_string(php.getFields().size()) + " fields";
+                }
+            });
+            //the mapping is closed on return, and a reused builder must not point into it
+            worker.builder.clearModel();
+            printDiagnostics();
+            if(classes == 0)
+            {
+                result.message = "no class declaration found";
+                return result;
+            }
+            if(!failures.empty())
+            {
+                result.message = failures;
+                return result;
+            }
+            result.success = true;
+            result.skipped = unchanged == classes;
+            if(classes > 1)
+            {
+                result.message = result.skipped ? "unchanged" : std::to_string(classes) + " classes";
+                if(unchanged > 0 && !result.skipped)
+                {
+                    result.message += ", " + std::to_string(unchanged) + " unchanged";
+                }
+            }
+            return result;
+        }
+
+    public:
+        /**
+         * Constructor that takes the root of the output directory
+         * @param outputRoot a string argument.
+         */
+        BatchGenerator(std::string outputRoot) : outputRoot(outputRoot) {}
+
+        /**
+         * Sets the templates every input is generated with
+         * @param templates PHPTemplateSet, null for built-in methods only
+         * @return void
+         */
+        void setTemplates(const PHPTemplateSet *templates)
+        {
+            this->templates = templates;
+        }
+
+        /**
+         * Sets the optional parts every class is generated with
+         * @param options PHPBuilderOptions
+         * @return void
+         */
+        void setOptions(const PHPBuilderOptions &options)
+        {
+            this->options = options;
+        }
+
+        /**
+         * Sets the tracer the workers record their spans
+         * into from the next run on. Null stops tracing.
+         * @param tracer Tracer, null for none
+         * @return void
+         */
+        void setTracer(Tracer *tracer)
+        {
+            this->tracer = tracer;
+        }
+
+        /**
+         * Sets whether only diagnostics and failed inputs
+         * are printed, leaving successful inputs out of the
+         * summary
+         * @param quiet bool
+         * @return void
+         */
+        void setQuiet(bool quiet)
+        {
+            this->quiet = quiet;
+        }
+
+        /**
+         * Enables the manifest of earlier outputs stored in the
+         * output directory. Inputs it reports as up to date are
+         * skipped unless force is set, in which case every input
+         * is regenerated and the manifest refreshed.
+         * @param force bool
+         * @return void
+         */
+        void enableCache(bool force)
+        {
+            this->cache = std::make_unique<GenerationCache>(this->outputRoot.string());
+            this->force = force;
+        }
+
+        /**
+         * Queues every .php file in a directory, and in its
+         * subdirectories when recursive is set. Returns false
+         * if the directory could not be read.
+         * @param directory a string argument.
+         * @param recursive bool
+         * @return bool
+         */
+        bool addDirectory(const std::string &directory, bool recursive)
+        {
+            std::error_code error;
+            std::filesystem::path base(directory);
+            if(!std::filesystem::is_directory(base, error))
+            {
+                return false;
+            }
+            std::vector<std::filesystem::path> files;
+            if(recursive)
+            {
+                for(std::filesystem::recursive_directory_iterator it(base, error), end; !error && it != end; it.increment(error))
+                {
+                    if(it->is_regular_file() && isPHPFile(it->path())){files.push_back(it->path());}
+                }
+            }
+            else
+            {
+                for(std::filesystem::directory_iterator it(base, error), end; !error && it != end; it.increment(error))
+                {
+                    if(it->is_regular_file() && isPHPFile(it->path())){files.push_back(it->path());}
+                }
+            }
+            std::sort(files.begin(), files.end());
+            for(const std::filesystem::path &f : files)
+            {
+                this->addJob(f, base);
+            }
+            return !error;
+        }
+
+        /**
+         * Queues a single .php file. Its output directory mirrors
+         * the file's location relative to base.
+         * @param file a string argument.
+         * @param base a string argument.
+         * @return void
+         */
+        void addFile(const std::string &file, const std::string &base)
+        {
+            this->addJob(file, base);
+        }
+
+        /**
+         * Queues every .php file named in a list file, one path
+         * per line. Blank lines and lines starting with # are
+         * skipped. Relative paths are mirrored from the current
+         * directory. Returns false if the list file could not
+         * be read.
+         * @param listFile a string argument.
+         * @return bool
+         */
+        bool addListFile(const std::string &listFile)
+        {
+            std::ifstream list(listFile);
+            if(!list.is_open())
+            {
+                return false;
+            }
+            std::filesystem::path base = std::filesystem::current_path();
+            for(std::string line; std::getline(list, line); )
+            {
+                while(!line.empty() && isspace(static_cast<unsigned char>(line.back()))){line.pop_back();}
+                if(line.empty() || line[0] == '#'){continue;}
+                std::filesystem::path file = std::filesystem::absolute(line);
+                if(isPHPFile(file))
+                {
+                    this->addJob(file, base);
+                }
+                else
+                {
+                    this->results.push_back({line, "", false, false, "is not a .php file", 0});
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Generates a class for every queued input using
+         * the given number of threads. Parsers and builders
+         * are kept between runs.
+         * @param threadCount unsigned
+         * @return void
+         */
+        void run(unsigned threadCount)
+        {
+            ThreadPool pool(threadCount);
+            while(this->workers.size() < pool.getThreadCount())
+            {
+                this->workers.push_back(std::make_unique<BatchWorker>());
+            }
+            for(std::unique_ptr<BatchWorker> &w : this->workers)
+            {
+                if(this->tracer == nullptr)
+                {
+                    w->trace = nullptr;
+                }
+                else if(w->trace == nullptr)
+                {
+                    w->trace = this->tracer->createBuffer();
+                }
+            }
+            size_t first = this->results.size();
+            this->results.resize(first + this->jobs.size());
+            for(size_t i = 0; i < this->jobs.size(); i++)
+            {
+                pool.submit([this, i, first](unsigned worker)
+                {
+                    std::ostringstream log;
+                    this->results[first + i] = this->generate(this->jobs[i], *this->workers[worker], log);
+                    if(log.tellp() > 0)
+                    {
+                        std::lock_guard<std::mutex> lock(this->consoleMutex);
+                        std::cout << log.str();
+                    }
+                });
+            }
+            pool.run();
+            this->jobs.clear();
+            if(this->cache && !this->cache->save())
+            {
+                std::cout << "Warning: the cache manifest could not be written.\n";
+            }
+        }
+
+        /**
+         * Writes one line per input with its outcome
+         * followed by the totals. In quiet mode only
+         * failed inputs get a line.
+         * @param os ostream to write the summary to
+         * @return void
+         */
+        void printSummary(std::ostream &os)
+        {
+            os << "\nSummary:\n";
+            for(const BatchResult &r : this->results)
+            {
+                if(this->quiet && r.success)
+                {
+                    continue;
+                }
+                if(r.skipped)
+                {
+                    os << "  SKIP  " << r.input << " -> " << r.output << " (" << r.message << ")\n";
+                }
+                else if(r.success)
+                {
+                    os << "  OK    " << r.input << " -> " << r.output << " (" << r.message << ")\n";
+                }
+                else
+                {
+                    os << "  FAIL  " << r.input << ": " << r.message << "\n";
+                }
+            }
+            size_t skipped = std::count_if(this->results.begin(), this->results.end(),
+                                           [](const BatchResult &r){return r.skipped;});
+            os << this->results.size() << " files, "
+               << this->results.size() - this->getFailureCount() - skipped << " generated, "
+               << skipped << " unchanged, "
+               << this->getFailureCount() << " failed.\n";
+        }
+
+        /**
+         * Getter
+         * Retrieves the number of inputs that failed
+         * @return size_t
+         */
+        size_t getFailureCount()
+        {
+            return std::count_if(this->results.begin(), this->results.end(),
+                                 [](const BatchResult &r){return !r.success;});
+        }
+
+        /**
+         * Getter
+         * Retrieves the number of problems the parser reported
+         * in the inputs generated so far
+         * @return size_t
+         */
+        size_t getDiagnosticCount()
+        {
+            size_t count = 0;
+            for(const BatchResult &r : this->results)
+            {
+                count += r.diagnostics;
+            }
+            return count;
+        }
+
+        /**
+         * Getter
+         * Retrieves the outcome of every input generated so far
+         * @return vector of BatchResult
+         */
+        const std::vector<BatchResult> &getResults(){return this->results;}
+
+        /**
+         * Forgets the outcome of earlier runs
+         * @return void
+         */
+        void clearResults(){this->results.clear();}
+
+        /**
+         * Getter
+         * Retrieves the number of queued inputs
+         * @return size_t
+         */
+        size_t getJobCount(){return this->jobs.size();}
+};
+#endif
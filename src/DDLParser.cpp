@@ -0,0 +1 @@
+#include "DDLParser.h"
\ No newline at end of file
@@ -0,0 +1,864 @@
+#ifndef DDLPARSER_H
+#define DDLPARSER_H
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "PHPBuilder.h"
+#include "PHPLexer.h"
+#include "StringArena.h"
+#include "Tracer.h"
+/*******************************************************************************
+ * DDLParser
+ *
+ * Reads a SQL schema, such as the output of mysqldump --no-data, and builds
+ * a PHPBuilder model from every CREATE TABLE statement in it. The class name
+ * is derived from the table name, every column becomes a field and the
+ * column types become field types so rows are converted when read.
+ * The schema is read in fixed size chunks and only the current CREATE TABLE
+ * statement is kept, with comments removed, so memory stays bounded by the
+ * largest table definition whatever the size of the file. Other statements
+ * are skipped without being stored. Each model is handed to a callback as
+ * soon as its statement ends and is only valid during the call.
+ *
+ *******************************************************************************/
+
+/**
+ * A single token of a CREATE TABLE statement
+ */
+struct DDLToken
+{
+    enum Type
+    {
+        End,
+        Word, /**< Keyword, unquoted identifier or number */
+        Quoted, /**< Identifier in backticks or double quotes, without them */
+        String, /**< Literal in single quotes, with them */
+        Symbol /**< Any other single character */
+    };
+    Type type; /**< Kind of token */
+    std::string_view text; /**< Text of the token within the statement */
+    size_t offset; /**< Position of the token within the statement */
+
+    /**
+     * Checks if the token is a given symbol
+     * @param c char
+     * @return bool
+     */
+    bool isSymbol(char c) const {return this->type == Symbol && this->text.size() == 1 && this->text[0] == c;}
+};
+
+class DDLParser
+{
+    public:
+        using ModelCallback = std::function<void(PHPBuilder &php)>; /**< Receives each model while it is valid */
+
+    private:
+        enum State
+        {
+            Code,
+            LineComment,
+            BlockComment,
+            SingleQuoted,
+            DoubleQuoted,
+            BackQuoted
+        };
+        static constexpr size_t chunkSize = 65536; /**< Bytes read from the schema at a time */
+        static constexpr size_t decideAt = 256; /**< Characters after which a statement must be a CREATE TABLE */
+        std::vector<PHPDiagnostic> diagnostics; /**< Problems found since the last model */
+        StringArena arena; /**< Names built for the current model */
+        std::string statement; /**< Current CREATE TABLE statement without comments */
+        State state = Code; /**< What the next character belongs to */
+        bool skipping = false; /**< True if the current statement is not a CREATE TABLE */
+        bool escaped = false; /**< True after a backslash in a quoted string */
+        char previous = 0; /**< Previous character of code, to find comment openers */
+        int line = 1; /**< Line of the next character */
+        int column = 1; /**< Column of the next character */
+        int statementLine = 1; /**< Line the current statement starts on */
+        int statementColumn = 1; /**< Column the current statement starts on */
+        size_t tableCount = 0; /**< Models handed to the callback */
+        std::string_view className; /**< Class name of the current model */
+        std::string_view tableName; /**< Table name of the current model */
+        std::vector<std::string_view> fields; /**< Columns of the current model */
+        std::vector<std::string_view> fieldTypes; /**< PHP type of each column */
+        TraceBuffer *trace = nullptr; /**< Buffer the parse of each statement is recorded into, null for none */
+
+        /**
+         * Compares a word with a keyword ignoring case, as
+         * SQL keywords are case insensitive
+         * @param text string_view
+         * @param keyword string in lower case
+         * @return bool
+         */
+        static bool isKeyword(std::string_view text, std::string_view keyword)
+        {
+            if(text.size() != keyword.size()){return false;}
+            for(size_t i = 0; i < text.size(); i++)
+            {
+                if(tolower(static_cast<unsigned char>(text[i])) != keyword[i]){return false;}
+            }
+            return true;
+        }
+
+        /**
+         * Checks if a token is a given keyword
+         * @param t DDLToken
+         * @param keyword string in lower case
+         * @return bool
+         */
+        static bool isKeyword(const DDLToken &t, std::string_view keyword)
+        {
+            return t.type == DDLToken::Word && isKeyword(t.text, keyword);
+        }
+
+        /**
+         * Checks if a character can be part of an unquoted
+         * word. Bytes of multibyte UTF-8 characters are.
+         * @param c char
+         * @return bool
+         */
+        static bool isWordChar(char c)
+        {
+            return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || static_cast<unsigned char>(c) >= 0x80;
+        }
+
+        /**
+         * Checks if a word starts a key, index or constraint
+         * of a column list instead of a column
+         * @param text string_view
+         * @return bool
+         */
+        static bool isConstraint(std::string_view text)
+        {
+            static const char *keywords[] = {"primary", "key", "index", "unique", "constraint", "foreign",
+                                             "fulltext", "spatial", "check", "period", "exclude", "like"};
+            for(const char *k : keywords)
+            {
+                if(isKeyword(text, k)){return true;}
+            }
+            return false;
+        }
+
+        /**
+         * Maps a SQL column type to the PHP type rows of the
+         * column are converted to, nullable unless the column
+         * is NOT NULL. Numeric types with more precision than
+         * a PHP float, dates and text are kept as strings.
+         * Returns an empty type for types that should not be
+         * converted.
+         * @param type string_view of the type name
+         * @param length string_view of its first argument, empty if none
+         * @param notNull bool
+         * @return string_view
+         */
+        static std::string_view getPHPType(std::string_view type, std::string_view length, bool notNull)
+        {
+            static const char *ints[] = {"tinyint", "smallint", "mediumint", "int", "integer", "bigint",
+                                         "int2", "int4", "int8", "serial", "bigserial", "smallserial", "year"};
+            static const char *floats[] = {"float", "double", "real", "float4", "float8"};
+            static const char *bools[] = {"bool", "boolean"};
+            static const char *strings[] = {"decimal", "numeric", "dec", "fixed", "money", "char", "varchar",
+                                            "character", "nchar", "nvarchar", "text", "tinytext", "mediumtext",
+                                            "longtext", "date", "datetime", "timestamp", "timestamptz", "time",
+                                            "timetz", "interval", "enum", "set", "json", "jsonb", "uuid",
+                                            "binary", "varbinary", "blob", "tinyblob", "mediumblob",
+                                            "longblob", "bytea", "citext"};
+            auto matches = [type](const auto &names)
+            {
+                return std::any_of(std::begin(names), std::end(names),
+                                   [type](const char *name){return isKeyword(type, name);});
+            };
+            //MySQL stores booleans as tinyint(1)
+            if(matches(bools) || (isKeyword(type, "tinyint") && length == "1"))
+            {
+                return notNull ? "bool" : "?bool";
+            }
+            if(matches(ints)){return notNull ? "int" : "?int";}
+            if(matches(floats)){return notNull ? "float" : "?float";}
+            if(matches(strings)){return notNull ? "string" : "?string";}
+            return {};
+        }
+
+        /**
+         * Reads the token starting at or after pos
+         * @param text string_view of the statement
+         * @param pos size_t position to read from, moved past the token
+         * @return DDLToken
+         */
+        DDLToken nextToken(std::string_view text, size_t &pos)
+        {
+            while(pos < text.size() && isspace(static_cast<unsigned char>(text[pos])))
+            {
+                pos++;
+            }
+            if(pos >= text.size())
+            {
+                return {DDLToken::End, {}, pos};
+            }
+            size_t start = pos;
+            char c = text[pos];
+            if(c == '`' || c == '"' || c == '\'')
+            {
+                //a doubled quote is part of the text
+                pos++;
+                while(pos < text.size())
+                {
+                    if(text[pos] == '\\' && c != '`'){pos += 2; continue;}
+                    if(text[pos] == c && (pos + 1 >= text.size() || text[pos + 1] != c)){break;}
+                    pos += text[pos] == c ? 2 : 1;
+                }
+                pos = std::min(pos + 1, text.size());
+                if(c == '\'')
+                {
+                    return {DDLToken::String, text.substr(start, pos - start), start};
+                }
+                return {DDLToken::Quoted, text.substr(start + 1, std::max<size_t>(pos - start, 2) - 2), start};
+            }
+            if(isWordChar(c))
+            {
+                while(pos < text.size() && isWordChar(text[pos]))
+                {
+                    pos++;
+                }
+                return {DDLToken::Word, text.substr(start, pos - start), start};
+            }
+            pos++;
+            return {DDLToken::Symbol, text.substr(start, 1), start};
+        }
+
+        /**
+         * Retrieves the name a word or quoted identifier
+         * stands for. Doubled quotes are undone in a copy
+         * kept in the arena. Other tokens have no name.
+         * @param t DDLToken
+         * @param text string_view of the statement
+         * @return string_view
+         */
+        std::string_view getName(const DDLToken &t, std::string_view text)
+        {
+            if(t.type == DDLToken::Word)
+            {
+                return t.text;
+            }
+            if(t.type != DDLToken::Quoted)
+            {
+                return {};
+            }
+            char quote = text[t.offset];
+            if(t.text.find(quote) == std::string_view::npos)
+            {
+                return t.text;
+            }
+            std::string name;
+            for(size_t i = 0; i < t.text.size(); i++)
+            {
+                name += t.text[i];
+                if(t.text[i] == quote){i++;}
+            }
+            return this->arena.store(name);
+        }
+
+        /**
+         * Records a problem at a position of the current
+         * statement
+         * @param offset size_t within the statement
+         * @param message string
+         * @return void
+         */
+        void addDiagnostic(size_t offset, std::string message)
+        {
+            int line = this->statementLine;
+            int column = this->statementColumn;
+            for(size_t i = 0; i < offset && i < this->statement.size(); i++)
+            {
+                if(this->statement[i] == '\n')
+                {
+                    line++;
+                    column = 1;
+                }
+                else
+                {
+                    column++;
+                }
+            }
+            this->diagnostics.push_back({line, column, std::move(message)});
+        }
+
+        /**
+         * Checks if the start of a statement is, or could
+         * still become, CREATE TABLE
+         * @param text string_view of the statement so far
+         * @return bool
+         */
+        bool startsCreateTable(std::string_view text)
+        {
+            size_t pos = 0;
+            DDLToken t = this->nextToken(text, pos);
+            if(t.type == DDLToken::End || (pos >= text.size() && t.type == DDLToken::Word))
+            {
+                return true;
+            }
+            if(!isKeyword(t, "create"))
+            {
+                return false;
+            }
+            while(true)
+            {
+                t = this->nextToken(text, pos);
+                if(t.type == DDLToken::End || (pos >= text.size() && t.type == DDLToken::Word))
+                {
+                    return true;
+                }
+                if(isKeyword(t, "table"))
+                {
+                    return true;
+                }
+                if(!isKeyword(t, "or") && !isKeyword(t, "replace") && !isKeyword(t, "temporary")
+                    && !isKeyword(t, "temp") && !isKeyword(t, "global") && !isKeyword(t, "local")
+                    && !isKeyword(t, "unlogged"))
+                {
+                    return false;
+                }
+            }
+        }
+
+        /**
+         * Adds a character of code to the current statement
+         * unless the statement is being skipped. Leading
+         * whitespace is dropped and the statement is skipped
+         * once it is clear it is not a CREATE TABLE.
+         * @param c char
+         * @return void
+         */
+        void append(char c)
+        {
+            if(this->skipping)
+            {
+                return;
+            }
+            if(this->statement.empty())
+            {
+                if(isspace(static_cast<unsigned char>(c)))
+                {
+                    return;
+                }
+                this->statementLine = this->line;
+                this->statementColumn = this->column;
+            }
+            this->statement.push_back(c);
+            if(this->statement.size() == decideAt && !this->startsCreateTable(this->statement))
+            {
+                this->skipping = true;
+                this->statement.clear();
+            }
+        }
+
+        /**
+         * Parses the column list of the current statement
+         * into fields and field types. Keys, indexes and
+         * constraints are left out, as are columns whose
+         * names cannot be PHP properties. Returns false if
+         * the list is not closed.
+         * @param text string_view of the statement
+         * @param pos size_t position after the opening parenthesis
+         * @return bool
+         */
+        bool parseColumns(std::string_view text, size_t &pos)
+        {
+            bool closed = false;
+            while(!closed)
+            {
+                DDLToken first = this->nextToken(text, pos);
+                if(first.type == DDLToken::End)
+                {
+                    return false;
+                }
+                if(first.isSymbol(')'))
+                {
+                    return true;
+                }
+                bool isColumn = first.type == DDLToken::Quoted
+                                || (first.type == DDLToken::Word && !isConstraint(first.text));
+                std::string_view type;
+                std::string_view length;
+                bool notNull = false;
+                int depth = 0;
+                DDLToken t = this->nextToken(text, pos);
+                if(isColumn && t.type == DDLToken::Word)
+                {
+                    type = t.text;
+                    t = this->nextToken(text, pos);
+                    if(t.isSymbol('('))
+                    {
+                        length = this->nextToken(text, pos).text;
+                        depth = 1;
+                        t = this->nextToken(text, pos);
+                    }
+                }
+                DDLToken before = first;
+                while(true)
+                {
+                    if(t.type == DDLToken::End)
+                    {
+                        return false;
+                    }
+                    if(depth == 0 && (t.isSymbol(',') || t.isSymbol(')')))
+                    {
+                        closed = t.isSymbol(')');
+                        break;
+                    }
+                    if(t.isSymbol('(')){depth++;}
+                    else if(t.isSymbol(')')){depth--;}
+                    else if(depth == 0 && isKeyword(t, "null") && isKeyword(before, "not")){notNull = true;}
+                    else if(depth == 0 && isKeyword(t, "key") && isKeyword(before, "primary")){notNull = true;}
+                    before = t;
+                    t = this->nextToken(text, pos);
+                }
+                if(isColumn)
+                {
+                    this->addColumn(first, text, type, length, notNull);
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Adds a column to the current model. A column
+         * named id in any case becomes the ID field the
+         * generated methods look records up by.
+         * @param name DDLToken with the column name
+         * @param text string_view of the statement
+         * @param type string_view of the SQL type
+         * @param length string_view of the first type argument
+         * @param notNull bool
+         * @return void
+         */
+        void addColumn(const DDLToken &name, std::string_view text, std::string_view type,
+                       std::string_view length, bool notNull)
+        {
+            std::string_view field = this->getName(name, text);
+            if(!isPHPIdentifier(field))
+            {
+                this->addDiagnostic(name.offset, "column '" + std::string(field) + "' of table '"
+                    + std::string(this->tableName) + "' is not a valid PHP property name, skipped");
+                return;
+            }
+            if(isKeyword(field, "id"))
+            {
+                field = "ID";
+            }
+            std::string_view lower = this->getLower(field);
+            for(std::string_view f : this->fields)
+            {
+                if(isKeyword(f, lower))
+                {
+                    this->addDiagnostic(name.offset, "column '" + std::string(field) + "' of table '"
+                        + std::string(this->tableName) + "' is declared twice, skipped");
+                    return;
+                }
+            }
+            this->fields.push_back(field);
+            this->fieldTypes.push_back(getPHPType(type, length, notNull));
+        }
+
+        /**
+         * Copies text into the arena in lower case
+         * @param text string_view
+         * @return string_view
+         */
+        std::string_view getLower(std::string_view text)
+        {
+            std::string lower(text);
+            for(char &c : lower)
+            {
+                c = tolower(static_cast<unsigned char>(c));
+            }
+            return this->arena.store(lower);
+        }
+
+        /**
+         * Derives a class name from a table name and
+         * keeps it in the arena
+         * @param table string_view
+         * @return string_view
+         */
+        std::string_view getClassName(std::string_view table)
+        {
+            return this->arena.store(toClassName(table));
+        }
+
+        /**
+         * Builds the model of the current statement if it
+         * is a CREATE TABLE with a column list and hands it
+         * to the callback
+         * @param php PHPBuilder to load the model into
+         * @param onModel ModelCallback
+         * @return void
+         */
+        void parseStatement(PHPBuilder &php, const ModelCallback &onModel)
+        {
+            int64_t start = this->trace != nullptr ? this->trace->now() : 0;
+            bool built = this->buildModel();
+            if(this->trace != nullptr){this->trace->add("parse", "phase", start);}
+            if(!built)
+            {
+                return;
+            }
+            php.setModel(this->className, this->fields, this->tableName);
+            php.setFieldTypes(this->fieldTypes);
+            php.setSortKeys({});
+            php.setSoftDelete({});
+            php.setPrimaryKey({});
+            php.setIndexes({});
+            this->tableCount++;
+            onModel(php);
+            this->diagnostics.clear();
+        }
+
+        /**
+         * Reads the class name, table name and columns of
+         * the current statement. Returns false if it is not
+         * a CREATE TABLE or has no usable columns.
+         * @return bool
+         */
+        bool buildModel()
+        {
+            this->arena.clear();
+            this->fields.clear();
+            this->fieldTypes.clear();
+            std::string_view text = this->statement;
+            size_t pos = 0;
+            DDLToken t = this->nextToken(text, pos);
+            if(!isKeyword(t, "create"))
+            {
+                return false;
+            }
+            for(t = this->nextToken(text, pos); !isKeyword(t, "table"); t = this->nextToken(text, pos))
+            {
+                if(!isKeyword(t, "or") && !isKeyword(t, "replace") && !isKeyword(t, "temporary")
+                    && !isKeyword(t, "temp") && !isKeyword(t, "global") && !isKeyword(t, "local")
+                    && !isKeyword(t, "unlogged"))
+                {
+                    return false;
+                }
+            }
+            t = this->nextToken(text, pos);
+            if(isKeyword(t, "if"))
+            {
+                //IF NOT EXISTS
+                this->nextToken(text, pos);
+                this->nextToken(text, pos);
+                t = this->nextToken(text, pos);
+            }
+            //only the table of schema.table is used
+            DDLToken name = t;
+            this->tableName = this->getName(t, text);
+            for(t = this->nextToken(text, pos); t.isSymbol('.'); t = this->nextToken(text, pos))
+            {
+                name = this->nextToken(text, pos);
+                this->tableName = this->getName(name, text);
+            }
+            if(this->tableName.empty())
+            {
+                this->addDiagnostic(name.offset, "expected a table name after CREATE TABLE");
+                return false;
+            }
+            if(!t.isSymbol('('))
+            {
+                this->addDiagnostic(name.offset, "table '" + std::string(this->tableName)
+                    + "' has no column list, skipped");
+                return false;
+            }
+            if(!this->parseColumns(text, pos))
+            {
+                this->addDiagnostic(t.offset, "column list of table '" + std::string(this->tableName)
+                    + "' is not closed, skipped");
+                return false;
+            }
+            this->className = this->getClassName(this->tableName);
+            if(!isPHPIdentifier(this->className) || isReserved(this->className))
+            {
+                this->addDiagnostic(name.offset, "class name '" + std::string(this->className) + "' of table '"
+                    + std::string(this->tableName) + "' is not a valid PHP class name, skipped");
+                return false;
+            }
+            if(this->fields.empty())
+            {
+                this->addDiagnostic(name.offset, "table '" + std::string(this->tableName)
+                    + "' has no columns, skipped");
+                return false;
+            }
+            if(std::find(this->fields.begin(), this->fields.end(), "ID") == this->fields.end())
+            {
+                this->addDiagnostic(name.offset, "table '" + std::string(this->tableName)
+                    + "' has no id column, methods that find records by ID will not work");
+            }
+            return true;
+        }
+
+        /**
+         * Ends the current statement, building its model
+         * if it is a CREATE TABLE
+         * @param php PHPBuilder to load the model into
+         * @param onModel ModelCallback
+         * @return void
+         */
+        void endStatement(PHPBuilder &php, const ModelCallback &onModel)
+        {
+            if(!this->skipping && !this->statement.empty())
+            {
+                this->parseStatement(php, onModel);
+            }
+            this->statement.clear();
+            this->skipping = false;
+            this->previous = 0;
+        }
+
+    public:
+        /**
+         * Checks if text can be used as a PHP class or
+         * property name
+         * @param text string_view
+         * @return bool
+         */
+        static bool isPHPIdentifier(std::string_view text)
+        {
+            if(text.empty() || isdigit(static_cast<unsigned char>(text[0])))
+            {
+                return false;
+            }
+            return std::all_of(text.begin(), text.end(),
+                [](char c){return c != '$' && isWordChar(c);});
+        }
+
+        /**
+         * Checks if a class name is reserved in PHP
+         * @param name string_view
+         * @return bool
+         */
+        static bool isReserved(std::string_view name)
+        {
+            static const char *words[] = {"array", "bool", "callable", "class", "default", "enum", "false",
+                                          "float", "function", "int", "iterable", "list", "match", "mixed",
+                                          "never", "new", "null", "object", "parent", "print", "self",
+                                          "static", "string", "true", "void"};
+            for(const char *w : words)
+            {
+                if(isKeyword(name, w)){return true;}
+            }
+            return false;
+        }
+
+        /**
+         * Derives a class name from a table name by
+         * starting each part separated by _, - or a
+         * space with a capital. Names that would start
+         * with a digit are prefixed with Table.
+         * @param table string_view
+         * @return string
+         */
+        static std::string toClassName(std::string_view table)
+        {
+            std::string name;
+            bool capital = true;
+            for(char c : table)
+            {
+                if(c == '_' || c == '-' || c == ' ')
+                {
+                    capital = true;
+                    continue;
+                }
+                name += capital ? static_cast<char>(toupper(static_cast<unsigned char>(c))) : c;
+                capital = false;
+            }
+            if(name.empty() || isdigit(static_cast<unsigned char>(name[0])))
+            {
+                name = "Table" + name;
+            }
+            return name;
+        }
+
+        /**
+         * Sets the buffer the parse of every CREATE TABLE
+         * statement is recorded into. Null, the default,
+         * records none.
+         * @param trace TraceBuffer
+         * @return void
+         */
+        void setTrace(TraceBuffer *trace)
+        {
+            this->trace = trace;
+        }
+
+        /**
+         * Parses the next part of a schema. Statements may
+         * be split anywhere between chunks. The callback
+         * is called with the model of every CREATE TABLE
+         * statement completed within the chunk.
+         * @param chunk string_view of the next bytes of the schema
+         * @param php PHPBuilder models are loaded into
+         * @param onModel ModelCallback
+         * @return void
+         */
+        void feed(std::string_view chunk, PHPBuilder &php, const ModelCallback &onModel)
+        {
+            for(char c : chunk)
+            {
+                switch(this->state)
+                {
+                    case LineComment:
+                        if(c == '\n')
+                        {
+                            this->state = Code;
+                            this->append(c);
+                        }
+                        break;
+                    case BlockComment:
+                        if(c == '\n')
+                        {
+                            this->append(c);
+                        }
+                        if(this->previous == '*' && c == '/')
+                        {
+                            this->state = Code;
+                            this->append(' ');
+                            c = 0;
+                        }
+                        this->previous = c;
+                        break;
+                    case SingleQuoted:
+                    case DoubleQuoted:
+                    case BackQuoted:
+                        this->append(c);
+                        if(this->escaped)
+                        {
+                            this->escaped = false;
+                        }
+                        else if(c == '\\' && this->state != BackQuoted)
+                        {
+                            this->escaped = true;
+                        }
+                        else if(c == (this->state == SingleQuoted ? '\'' : this->state == DoubleQuoted ? '"' : '`'))
+                        {
+                            this->state = Code;
+                        }
+                        break;
+                    case Code:
+                        if((c == '-' && this->previous == '-') || (c == '*' && this->previous == '/') || c == '#')
+                        {
+                            //the first character of the opener was already added
+                            if(c != '#' && !this->skipping && !this->statement.empty())
+                            {
+                                this->statement.pop_back();
+                            }
+                            this->state = c == '*' ? BlockComment : LineComment;
+                            this->previous = 0;
+                            break;
+                        }
+                        this->previous = c;
+                        if(c == ';')
+                        {
+                            this->endStatement(php, onModel);
+                            break;
+                        }
+                        if(c == '\''){this->state = SingleQuoted;}
+                        else if(c == '"'){this->state = DoubleQuoted;}
+                        else if(c == '`'){this->state = BackQuoted;}
+                        this->append(c);
+                        break;
+                }
+                if(c == '\n')
+                {
+                    this->line++;
+                    this->column = 1;
+                }
+                else
+                {
+                    this->column++;
+                }
+            }
+        }
+
+        /**
+         * Ends the schema, building the model of a last
+         * statement without a semicolon. Reports a comment
+         * or quoted text that is not closed.
+         * @param php PHPBuilder models are loaded into
+         * @param onModel ModelCallback
+         * @return void
+         */
+        void finish(PHPBuilder &php, const ModelCallback &onModel)
+        {
+            if(this->state == BlockComment)
+            {
+                this->diagnostics.push_back({this->line, this->column, "comment is not closed"});
+            }
+            else if(this->state != Code && this->state != LineComment)
+            {
+                this->diagnostics.push_back({this->statementLine, this->statementColumn,
+                                             "quoted text is not closed, statement skipped"});
+                this->skipping = true;
+            }
+            this->endStatement(php, onModel);
+            this->state = Code;
+            this->escaped = false;
+        }
+
+        /**
+         * Parses a schema file chunk by chunk, calling
+         * onModel with the model of every CREATE TABLE
+         * statement in it. The builder is loaded with
+         * each model before the call and the model is
+         * only valid during it. Diagnostics found since
+         * the previous model can be read in the callback
+         * and are cleared after it. Returns false if the
+         * file could not be opened.
+         * @param fileName string
+         * @param php PHPBuilder models are loaded into
+         * @param onModel ModelCallback
+         * @return bool
+         */
+        bool parseFile(const std::string &fileName, PHPBuilder &php, const ModelCallback &onModel)
+        {
+            std::ifstream input(fileName, std::ios::binary);
+            if(!input)
+            {
+                return false;
+            }
+            this->diagnostics.clear();
+            this->statement.clear();
+            this->state = Code;
+            this->skipping = false;
+            this->escaped = false;
+            this->previous = 0;
+            this->line = 1;
+            this->column = 1;
+            this->tableCount = 0;
+            std::vector<char> chunk(chunkSize);
+            while(input.read(chunk.data(), chunk.size()) || input.gcount() > 0)
+            {
+                this->feed(std::string_view(chunk.data(), input.gcount()), php, onModel);
+            }
+            this->finish(php, onModel);
+            return !input.bad();
+        }
+
+        /**
+         * Getter
+         * Retrieves the problems found since the last model
+         * @return vector of PHPDiagnostic
+         */
+        const std::vector<PHPDiagnostic> &getDiagnostics() const {return this->diagnostics;}
+
+        /**
+         * Getter
+         * Retrieves the number of models handed to the
+         * callback by the last parseFile
+         * @return size_t
+         */
+        size_t getTableCount() const {return this->tableCount;}
+};
+#endif
@@ -0,0 +1 @@
+#include "FileWatcher.h"
\ No newline at end of file
@@ -0,0 +1,216 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+/*******************************************************************************
+ * FileWatcher
+ *
+ * Watches input directories with inotify and reports the .php files that were
+ * written or moved into them. Bursts of events, such as an editor writing a
+ * backup and then the file, are coalesced: once a change arrives the watcher
+ * keeps reading until no event has been seen for the debounce interval and
+ * then reports every changed file once. Only available on Linux.
+ *
+ *******************************************************************************/
+
+/**
+ * A .php file that changed and when the change was first seen
+ */
+struct WatchedChange
+{
+    std::string file; /**< Path of the changed file */
+    std::string base; /**< Watched directory the output layout is mirrored from */
+    std::chrono::steady_clock::time_point seen; /**< When the first event for the file was read */
+};
+
+class FileWatcher
+{
+    private:
+        /**
+         * A directory with an inotify watch on it
+         */
+        struct WatchedDirectory
+        {
+            std::string path; /**< Path of the directory */
+            std::string base; /**< Directory passed to addDirectory */
+            bool recursive; /**< True if new subdirectories are watched too */
+        };
+
+        int fd = -1; /**< inotify file descriptor */
+        int debounceMilliseconds; /**< Quiet time that ends a burst of events */
+        std::map<int, WatchedDirectory> directories; /**< Directories keyed by watch descriptor */
+
+        /**
+         * Checks if a file name has a .php extension in any case
+         * @param name string
+         * @return bool
+         */
+        static bool isPHPFile(const std::string &name)
+        {
+            std::string extension = std::filesystem::path(name).extension().string();
+            for(char &c : extension)
+            {
+                c = tolower(static_cast<unsigned char>(c));
+            }
+            return extension == ".php";
+        }
+
+        /**
+         * Adds a watch on one directory
+         * @param path string
+         * @param base string
+         * @param recursive bool
+         * @return bool
+         */
+        bool watch(const std::string &path, const std::string &base, bool recursive)
+        {
+#ifdef __linux__
+            int wd = inotify_add_watch(this->fd, path.c_str(),
+                                       IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+            if(wd < 0)
+            {
+                return false;
+            }
+            this->directories[wd] = {path, base, recursive};
+            return true;
+#else
+            return false;
+#endif
+        }
+
+    public:
+        /**
+         * Constructor that takes the quiet time in milliseconds
+         * after which a burst of events is reported
+         * @param debounceMilliseconds int
+         */
+        FileWatcher(int debounceMilliseconds) : debounceMilliseconds(debounceMilliseconds)
+        {
+#ifdef __linux__
+            this->fd = inotify_init1(IN_CLOEXEC);
+#endif
+        }
+
+        /**
+         * Destructor that closes the inotify descriptor
+         */
+        ~FileWatcher()
+        {
+#ifdef __linux__
+            if(this->fd >= 0){close(this->fd);}
+#endif
+        }
+
+        FileWatcher(const FileWatcher &) = delete;
+        FileWatcher &operator=(const FileWatcher &) = delete;
+
+        /**
+         * Checks if file watching is available
+         * @return bool
+         */
+        bool isSupported(){return this->fd >= 0;}
+
+        /**
+         * Watches a directory, and all of its subdirectories when
+         * recursive is set. Subdirectories created later are
+         * watched as they appear. Returns false if a watch could
+         * not be added.
+         * @param directory a string argument.
+         * @param recursive bool
+         * @return bool
+         */
+        bool addDirectory(const std::string &directory, bool recursive)
+        {
+            if(!this->watch(directory, directory, recursive))
+            {
+                return false;
+            }
+            if(recursive)
+            {
+                std::error_code error;
+                for(std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+                {
+                    if(it->is_directory() && !this->watch(it->path().string(), directory, recursive))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Getter
+         * Retrieves the number of watched directories
+         * @return size_t
+         */
+        size_t getDirectoryCount(){return this->directories.size();}
+
+        /**
+         * Blocks until at least one .php file changes and the
+         * burst of events has settled, then returns every file
+         * that changed, each once. Returns an empty vector if
+         * the watcher failed.
+         * @return vector of WatchedChange
+         */
+        std::vector<WatchedChange> wait()
+        {
+            std::vector<WatchedChange> changes;
+#ifdef __linux__
+            std::set<std::string> seen;
+            alignas(struct inotify_event) char buffer[16384];
+            while(true)
+            {
+                struct pollfd ready = {this->fd, POLLIN, 0};
+                int count = poll(&ready, 1, changes.empty() ? -1 : this->debounceMilliseconds);
+                if(count < 0 && errno == EINTR){continue;}
+                if(count < 0){return {};}
+                if(count == 0){break;}
+                ssize_t length = read(this->fd, buffer, sizeof(buffer));
+                if(length < 0 && errno == EINTR){continue;}
+                if(length <= 0){return {};}
+                auto now = std::chrono::steady_clock::now();
+                for(ssize_t offset = 0; offset < length; )
+                {
+                    const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+                    offset += sizeof(struct inotify_event) + event->len;
+                    auto found = this->directories.find(event->wd);
+                    if(found == this->directories.end()){continue;}
+                    if(event->mask & IN_IGNORED)
+                    {
+                        this->directories.erase(found);
+                        continue;
+                    }
+                    if(event->len == 0){continue;}
+                    WatchedDirectory directory = found->second;
+                    std::string path = (std::filesystem::path(directory.path) / event->name).string();
+                    if(event->mask & IN_ISDIR)
+                    {
+                        if(directory.recursive && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                        {
+                            this->watch(path, directory.base, true);
+                        }
+                        continue;
+                    }
+                    if((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && isPHPFile(event->name)
+                        && seen.insert(path).second)
+                    {
+                        changes.push_back({path, directory.base, now});
+                    }
+                }
+            }
+#endif
+            return changes;
+        }
+};
+#endif
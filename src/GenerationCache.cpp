@@ -0,0 +1 @@
+#include "GenerationCache.h"
\ No newline at end of file
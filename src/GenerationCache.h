@@ -0,0 +1,167 @@
+#ifndef GENERATIONCACHE_H
+#define GENERATIONCACHE_H
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include "OutputBuffer.h"
+#include "PHPBuilder.h"
+/*******************************************************************************
+ * GenerationCache
+ *
+ * Manifest stored in the output directory that remembers, for every input,
+ * the hash of its parsed model and the size and modification time of the
+ * class generated from it. An input whose hash still matches and whose output
+ * has not been touched since can be skipped without rendering or writing.
+ *
+ *******************************************************************************/
+
+/**
+ * What was generated from one input
+ */
+struct CacheEntry
+{
+    uint64_t hash; /**< PHPBuilder::getModelHash of the input */
+    std::string output; /**< Path of the generated class */
+    uintmax_t size; /**< Size of the generated class */
+    int64_t modified; /**< Modification time of the generated class */
+};
+
+class GenerationCache
+{
+    private:
+        std::string manifestName; /**< Path of the manifest file */
+        std::map<std::string, CacheEntry> entries; /**< Entries keyed by input path and class or table name */
+        std::mutex mutex; /**< Guards entries between worker threads */
+        bool changed = false; /**< True if entries differ from the manifest on disk */
+
+        /**
+         * Reads the size and modification time of a file.
+         * Returns false if the file does not exist.
+         * @param fileName string
+         * @param size uintmax_t to fill
+         * @param modified int64_t to fill
+         * @return bool
+         */
+        static bool statFile(const std::string &fileName, uintmax_t &size, int64_t &modified)
+        {
+            std::error_code error;
+            size = std::filesystem::file_size(fileName, error);
+            if(error){return false;}
+            modified = std::filesystem::last_write_time(fileName, error).time_since_epoch().count();
+            return !error;
+        }
+
+    public:
+        /**
+         * Constructor that takes the directory the manifest is
+         * stored in and loads it if it exists. A manifest written
+         * by another generator version is ignored.
+         * @param outputDirectory a string argument.
+         */
+        GenerationCache(const std::string &outputDirectory)
+        {
+            this->manifestName = (std::filesystem::path(outputDirectory) / ".phpclassbuilder-cache").string();
+            std::ifstream manifest(this->manifestName);
+            std::string header;
+            if(!std::getline(manifest, header) || header != "PHPClassBuilder " PHPBUILDER_VERSION)
+            {
+                return;
+            }
+            for(std::string line; std::getline(manifest, line); )
+            {
+                std::istringstream fields(line);
+                std::string hash, size, modified, output, input;
+                if(std::getline(fields, hash, '\t') && std::getline(fields, size, '\t')
+                    && std::getline(fields, modified, '\t') && std::getline(fields, output, '\t')
+                    && std::getline(fields, input))
+                {
+                    try
+                    {
+                        this->entries[input] = {std::stoull(hash, nullptr, 16), output,
+                                                std::stoull(size), std::stoll(modified)};
+                    }
+                    catch(const std::exception &)
+                    {
+                        //a damaged line only costs regenerating that input
+                    }
+                }
+            }
+        }
+
+        /**
+         * Checks if the output generated from an input is still
+         * current: the model hash matches and the output file has
+         * the size and modification time recorded when it was
+         * written.
+         * @param input path of the input file
+         * @param hash PHPBuilder::getModelHash of the input
+         * @param output path the class would be written to
+         * @return bool
+         */
+        bool isUpToDate(const std::string &input, uint64_t hash, const std::string &output)
+        {
+            CacheEntry entry;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                auto found = this->entries.find(input);
+                if(found == this->entries.end()){return false;}
+                entry = found->second;
+            }
+            uintmax_t size;
+            int64_t modified;
+            return entry.hash == hash && entry.output == output
+                    && statFile(output, size, modified)
+                    && size == entry.size && modified == entry.modified;
+        }
+
+        /**
+         * Records the output generated from an input
+         * @param input path of the input file
+         * @param hash PHPBuilder::getModelHash of the input
+         * @param output path of the generated class
+         * @return void
+         */
+        void record(const std::string &input, uint64_t hash, const std::string &output)
+        {
+            CacheEntry entry = {hash, output, 0, 0};
+            if(!statFile(output, entry.size, entry.modified))
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->entries[input] = entry;
+            this->changed = true;
+        }
+
+        /**
+         * Writes the manifest if any entry changed. Returns
+         * false if it could not be written.
+         * @return bool
+         */
+        bool save()
+        {
+            if(!this->changed)
+            {
+                return true;
+            }
+            OutputBuffer manifest;
+            manifest << "PHPClassBuilder " PHPBUILDER_VERSION "\n";
+            char hash[17];
+            for(const auto &entry : this->entries)
+            {
+                snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)entry.second.hash);
+                manifest << hash << '\t' << std::to_string(entry.second.size) << '\t'
+                         << std::to_string(entry.second.modified) << '\t'
+                         << entry.second.output << '\t' << entry.first << '\n';
+            }
+            this->changed = false;
+            return manifest.writeFile(this->manifestName);
+        }
+};
+#endif
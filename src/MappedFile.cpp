@@ -0,0 +1 @@
+#include "MappedFile.h"
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+/*******************************************************************************
+ * MappedFile
+ *
+ * Maps an input file read-only into memory so it can be parsed in place.
+ * Tokens and parsed models hold string_views into the mapping, so the
+ * MappedFile must outlive anything parsed from it.
+ *
+ *******************************************************************************/
+class MappedFile
+{
+    private:
+        const char *data = nullptr; /**< Start of the mapping, null for empty files */
+        size_t size = 0; /**< Length of the file in bytes */
+        bool opened = false; /**< True if the file could be opened and mapped */
+
+    public:
+        /**
+         * Constructor that maps a file. Use isOpen to check
+         * whether it succeeded.
+         * @param fileName a string argument.
+         */
+        MappedFile(const std::string &fileName)
+        {
+            int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd < 0)
+            {
+                return;
+            }
+            struct stat info;
+            if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+            {
+                this->size = info.st_size;
+                this->opened = true;
+                if(this->size > 0)
+                {
+                    void *mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if(mapping == MAP_FAILED)
+                    {
+                        this->opened = false;
+                        this->size = 0;
+                    }
+                    else
+                    {
+                        //the file is read once from start to end
+                        madvise(mapping, this->size, MADV_SEQUENTIAL);
+                        this->data = static_cast<const char *>(mapping);
+                    }
+                }
+            }
+            close(fd);
+        }
+
+        /**
+         * Destructor that unmaps the file
+         */
+        ~MappedFile()
+        {
+            if(this->data != nullptr)
+            {
+                munmap(const_cast<char *>(this->data), this->size);
+            }
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /**
+         * Checks if the file was opened and mapped
+         * @return bool
+         */
+        bool isOpen() const {return this->opened;}
+
+        /**
+         * Getter
+         * Retrieves the contents of the file
+         * @return string_view
+         */
+        std::string_view view() const {return std::string_view(this->data, this->size);}
+};
+#endif
@@ -0,0 +1 @@
+#include "OutputBuffer.h"
\ No newline at end of file
@@ -0,0 +1,188 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+#include <string>
+#include <string_view>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+/*******************************************************************************
+ * OutputBuffer
+ *
+ * Growable in-memory buffer a generated file is rendered into. Supports the
+ * same << chains used with an ofstream. Once rendering is finished the whole
+ * buffer is written to a temporary file next to the target with one write
+ * and renamed over the target, so readers never see a half-written file.
+ *
+ *******************************************************************************/
+class OutputBuffer
+{
+    private:
+        std::string data; /**< Rendered bytes */
+
+    public:
+        /**
+         * Appends text to the buffer
+         * @param text string_view
+         * @return OutputBuffer
+         */
+        OutputBuffer &operator<<(std::string_view text)
+        {
+            this->data.append(text.data(), text.size());
+            return *this;
+        }
+
+        /**
+         * Appends a single character to the buffer
+         * @param c char
+         * @return OutputBuffer
+         */
+        OutputBuffer &operator<<(char c)
+        {
+            this->data.push_back(c);
+            return *this;
+        }
+
+        /**
+         * Appends text broken into lines of at most width
+         * characters. Each line starts with indent and ends
+         * with a newline. Lines are broken at the last space
+         * that fits and the spaces at the break are dropped.
+         * A word longer than width is kept whole on a line of
+         * its own. Runs in a single pass over text and does
+         * not copy it.
+         * @param text string_view
+         * @param width maximum characters per line, not counting indent
+         * @param indent string_view written before every line
+         * @return OutputBuffer
+         */
+        OutputBuffer &writeWrapped(std::string_view text, size_t width, std::string_view indent)
+        {
+            size_t start = 0;
+            do
+            {
+                size_t end = text.size();
+                if(text.size() - start > width)
+                {
+                    end = text.rfind(' ', start + width);
+                    if(end == std::string_view::npos || end <= start)
+                    {
+                        //no space in reach, so the word overflows the line
+                        end = text.find(' ', start + width);
+                        if(end == std::string_view::npos){end = text.size();}
+                    }
+                }
+                *this << indent << text.substr(start, end - start) << '\n';
+                start = end;
+                while(start < text.size() && text[start] == ' ')
+                {
+                    start++;
+                }
+            }
+            while(start < text.size());
+            return *this;
+        }
+
+        /**
+         * Empties the buffer while keeping its capacity
+         * so it can be reused for the next file
+         * @return void
+         */
+        void clear(){this->data.clear();}
+
+        /**
+         * Makes sure the buffer can hold at least size bytes
+         * without growing
+         * @param size size_t
+         * @return void
+         */
+        void reserve(size_t size){this->data.reserve(size);}
+
+        /**
+         * Getter
+         * Retrieves the number of rendered bytes
+         * @return size_t
+         */
+        size_t size() const {return this->data.size();}
+
+        /**
+         * Getter
+         * Retrieves the rendered bytes
+         * @return string_view
+         */
+        std::string_view view() const {return this->data;}
+
+        /**
+         * Checks if a file already holds exactly the bytes in
+         * the buffer. Returns false if the file does not exist.
+         * @param fileName string
+         * @return bool
+         */
+        bool matchesFile(const std::string &fileName) const
+        {
+            struct stat info;
+            if(stat(fileName.c_str(), &info) != 0 || info.st_size != (off_t)this->data.size())
+            {
+                return false;
+            }
+            int fd = open(fileName.c_str(), O_RDONLY);
+            if(fd < 0)
+            {
+                return false;
+            }
+            char chunk[16384];
+            size_t offset = 0;
+            bool same = true;
+            while(same)
+            {
+                ssize_t count = read(fd, chunk, sizeof(chunk));
+                if(count < 0 && errno == EINTR){continue;}
+                if(count <= 0){break;}
+                same = offset + count <= this->data.size()
+                        && this->data.compare(offset, count, chunk, count) == 0;
+                offset += count;
+            }
+            close(fd);
+            return same && offset == this->data.size();
+        }
+
+        /**
+         * Writes the buffer to a file. The bytes are written to
+         * a temporary file in the same directory, which is then
+         * renamed over fileName. Returns false and leaves any
+         * existing file untouched if a step fails.
+         * @param fileName string
+         * @return bool
+         */
+        bool writeFile(const std::string &fileName) const
+        {
+            std::string tempName = fileName + ".XXXXXX";
+            int fd = mkstemp(&tempName[0]);
+            if(fd < 0)
+            {
+                return false;
+            }
+            fchmod(fd, 0644);
+            const char *next = this->data.data();
+            size_t remaining = this->data.size();
+            while(remaining > 0)
+            {
+                ssize_t written = write(fd, next, remaining);
+                if(written < 0)
+                {
+                    if(errno == EINTR){continue;}
+                    break;
+                }
+                next += written;
+                remaining -= written;
+            }
+            if(close(fd) != 0 || remaining > 0 || rename(tempName.c_str(), fileName.c_str()) != 0)
+            {
+                unlink(tempName.c_str());
+                return false;
+            }
+            return true;
+        }
+};
+#endif
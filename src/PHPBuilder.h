@@ -1,22 +1,110 @@
+#ifndef PHPBUILDER_H
+#define PHPBUILDER_H
+#include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <filesystem>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <cstdint>
+#include "OutputBuffer.h"
+#include "PHPTemplate.h"
+#include "Tracer.h"
+
+/**
+ * Version of the generated code. Must be changed whenever the
+ * output of PHPBuilder changes so cached outputs are regenerated.
+ */
+#define PHPBUILDER_VERSION "1.12.1"
+
+/**
+ * Switches for optional parts of the generated class
+ */
+struct PHPBuilderOptions
+{
+    bool statementCache = false; /**< Reuse prepared statements across calls */
+    bool approxCount = false; /**< Add countApprox and countCached next to count */
+};
+
+/**
+ * An index of the table, used to generate lookups that can use it
+ */
+struct PHPIndex
+{
+    std::string_view name; /**< Name of the index */
+    bool unique = false; /**< True if no two rows share its columns */
+    std::vector<std::string_view> columns; /**< Indexed fields in index order */
+};
+
+/**
+ * A findBy method generated for an index
+ */
+struct ModelFinder
+{
+    std::string name; /**< Method name, findBy followed by the columns */
+    std::string parameters; /**< PHP parameters, one per column, separated by commas */
+    std::string whereClause; /**< Column = ? conditions in index order */
+    bool unique = false; /**< True to return one object or null instead of an array */
+    OutputBuffer comment; /**< Wrapped comment block of the method */
+};
+
+/**
+ * Strings derived from a model that several methods need.
+ * Built once per class by PHPBuilder::buildContext so the
+ * emitters only copy them into the output.
+ */
+struct ModelContext
+{
+    std::string classNameLower; /**< Name of the class in lower case */
+    std::string plural; /**< Lower case name of the class followed by s */
+    std::string columnList; /**< Fields separated by commas */
+    std::string selectList; /**< Columns read by the select methods, * if the class has no fields */
+    std::string columnArray; /**< Fields as quoted PHP strings separated by commas */
+    std::string bindList; /**< Named parameters for the fields separated by commas */
+    std::string rowPlaceholders; /**< One ? per field in parentheses, a row of a multi-row VALUES list */
+    std::string newColumnList; /**< Fields other than ID separated by commas, the columns of rows given a new ID */
+    std::string newRowPlaceholders; /**< One ? per field other than ID in parentheses */
+    std::string setClause; /**< Column=:parameter pairs of the insert query */
+    std::string whereClause; /**< Conditions matching every field of the checkIfExists query */
+    std::vector<std::string_view> keyColumns; /**< Columns rows are ordered by for keyset paging, ending with ID */
+    std::string keysetWhere; /**< Condition selecting the rows after a key, one ? per bound value */
+    std::string keysetOrder; /**< ORDER BY list matching keyColumns */
+    std::vector<std::string_view> keysetBindings; /**< Column bound to each ? of keysetWhere in order */
+    std::string liveCondition; /**< Condition leaving out soft deleted rows, empty without soft_delete */
+    std::vector<std::string> rowCasts; /**< Expression converting each field of $row to its declared type, empty for none */
+    OutputBuffer comments[PHPTemplateSet::MethodCount]; /**< Wrapped comment blocks of the built-in methods */
+    OutputBuffer hydrateAllComment; /**< Wrapped comment block of hydrateAll, written with Hydrate */
+    std::vector<ModelFinder> finders; /**< findBy method of each usable index, written with FindBy */
+};
 /*******************************************************************************
  * PHPBuilder
  *
  * Class takes a name, fields and table name to build a PHP file with common 
- * CRUD functions. 
+ * CRUD functions. The name, fields and table name are views into the parsed
+ * input and are not copied, so the input must outlive createClassFile.
  * 
  *******************************************************************************/
 class PHPBuilder
 {
     private: 
-        std::string className; /**< Name of PHP class */
-        std::vector<std::string> Fields; /**< Vector of class properties */ 
-        std::string tableName; /**< Name of table or view interacted with */ 
+        std::string_view className; /**< Name of PHP class */
+        std::vector<std::string_view> Fields; /**< Vector of class properties */ 
+        std::vector<std::string_view> fieldTypes; /**< Declared type of each property, empty if untyped */
+        std::string_view tableName; /**< Name of table or view interacted with */ 
+        std::vector<std::string_view> sortKeys; /**< Columns keyset paging orders by before ID */
+        std::string_view softDelete; /**< Column marking soft deleted rows, empty to delete rows */
+        std::vector<std::string_view> primaryKey; /**< Columns of the primary key, empty if unknown */
+        std::vector<PHPIndex> indexes; /**< Indexes of the table, empty if unknown */
         std::string fileName; /**< Name of PHP output file */
-        std::ofstream out; /**< Output File Handle */
+        std::string outputDirectory; /**< Directory the output file is written to */
+        OutputBuffer out; /**< Buffer the class is rendered into before it is written */
+        std::ostream *log = &std::cout; /**< Stream progress messages are written to, null for none */
+        TraceBuffer *trace = nullptr; /**< Buffer the spans of each part are recorded into, null for none */
+        const PHPTemplateSet *templates = nullptr; /**< Templates replacing built-in methods, null for none */
+        ModelContext context; /**< Derived strings of the current model */
+        size_t commentWidth = 70; /**< Characters per line of method descriptions */
+        PHPBuilderOptions options; /**< Optional parts of the generated class */
 
     public: 
         /**
@@ -27,41 +115,344 @@ class PHPBuilder
         /**
         * Constructor that takes a class Name,
         *  vector of fields and name of table.
-        * Sets the properties and creates the out
-        * output fille handler. 
-        * @param className a string argument.
-        * @param Fields a vector of strings.
-        * @param tableName a string argument
+        * Sets the properties and the name of the
+        * output file. Nothing is written until
+        * createClassFile has rendered the whole class. 
+        * @param className a string_view argument.
+        * @param Fields a vector of string_views.
+        * @param tableName a string_view argument
+        */
+        PHPBuilder(std::string_view className, const std::vector<std::string_view> &Fields, std::string_view tableName)
+        {
+            this->setModel(className, Fields, tableName);
+        }
+
+        /**
+        * Replaces the class name, fields and table
+        * name so one builder can generate several
+        * classes in a row. The output file name is
+        * recalculated from the class name.
+        * @param className a string_view argument.
+        * @param Fields a vector of string_views.
+        * @param tableName a string_view argument
+        * @return void
         */
-        PHPBuilder(std::string className, std::vector<std::string> Fields, std::string tableName)
+        void setModel(std::string_view className, const std::vector<std::string_view> &Fields, std::string_view tableName)
         {
             this->className = className; 
             this->Fields = Fields;
             this->tableName = tableName; 
-            this->fileName = className + ".php"; 
-            this->out.open(fileName, std::ios::out);
+            this->updateFileName();
+        }
+
+        /**
+        * Drops the model so the builder no longer
+        * points into the input it was parsed from.
+        * Called before that input is closed when the
+        * builder is reused for another one.
+        * @return void
+        */
+        void clearModel()
+        {
+            this->setModel({}, {}, {});
+            this->fieldTypes.clear();
+            this->sortKeys.clear();
+            this->softDelete = {};
+            this->primaryKey.clear();
+            this->indexes.clear();
+        }
+
+        /**
+        * Sets the directory the PHP output file is
+        * written to. An empty string writes to the
+        * current directory.
+        * @param outputDirectory a string argument.
+        * @return void
+        */
+        void setOutputDirectory(const std::string &outputDirectory)
+        {
+            this->outputDirectory = outputDirectory;
+            this->updateFileName();
+        }
+
+        /**
+        * Calculates a 64 bit FNV-1a hash of the class
+        * name, fields, table name and generator version.
+        * Two builders with the same hash generate the
+        * same class file.
+        * @return uint64_t
+        */
+        uint64_t getModelHash()
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            auto mix = [&hash](std::string_view text)
+            {
+                for(unsigned char c : text)
+                {
+                    hash = (hash ^ c) * 1099511628211ULL;
+                }
+                //separator so ("ab", "c") and ("a", "bc") differ
+                hash = (hash ^ 0xff) * 1099511628211ULL;
+            };
+            mix(PHPBUILDER_VERSION);
+            mix(this->className);
+            mix(this->tableName);
+            for(std::string_view f : this->Fields)
+            {
+                mix(f);
+            }
+            mix("sort_key");
+            for(std::string_view k : this->sortKeys)
+            {
+                mix(k);
+            }
+            mix("types");
+            for(std::string_view t : this->fieldTypes)
+            {
+                mix(t);
+            }
+            mix("soft_delete");
+            mix(this->softDelete);
+            mix("primary_key");
+            for(std::string_view k : this->primaryKey)
+            {
+                mix(k);
+            }
+            for(const PHPIndex &index : this->indexes)
+            {
+                mix(index.unique ? "unique index" : "index");
+                mix(index.name);
+                for(std::string_view column : index.columns)
+                {
+                    mix(column);
+                }
+            }
+            if(this->templates != nullptr)
+            {
+                mix(std::to_string(this->templates->getHash()));
+            }
+            mix(this->options.statementCache ? "statement cache" : "");
+            mix(this->options.approxCount ? "approximate count" : "");
+            return hash;
+        }
+
+        /**
+        * Sets the columns keyset paging orders by before
+        * ID. An empty vector pages by ID alone.
+        * @param sortKeys a vector of string_views.
+        * @return void
+        */
+        void setSortKeys(const std::vector<std::string_view> &sortKeys)
+        {
+            this->sortKeys = sortKeys;
+        }
+
+        /**
+        * Sets the declared PHP type of each field, in the
+        * order of the fields. Rows read from the database
+        * are converted to these types. Fields without a
+        * type, or missing from the vector, are not converted.
+        * @param fieldTypes a vector of string_views.
+        * @return void
+        */
+        void setFieldTypes(const std::vector<std::string_view> &fieldTypes)
+        {
+            this->fieldTypes = fieldTypes;
+        }
+
+        /**
+        * Sets the column that marks soft deleted rows.
+        * With a column, remove and removeMany set it
+        * instead of deleting rows and the read methods
+        * leave out rows where it is set. An empty
+        * column deletes rows.
+        * @param softDelete a string_view argument.
+        * @return void
+        */
+        void setSoftDelete(std::string_view softDelete)
+        {
+            this->softDelete = softDelete;
+        }
+
+        /**
+        * Sets the columns of the primary key of the table.
+        * A key other than ID gets a findBy method.
+        * @param primaryKey a vector of string_views.
+        * @return void
+        */
+        void setPrimaryKey(const std::vector<std::string_view> &primaryKey)
+        {
+            this->primaryKey = primaryKey;
+        }
+
+        /**
+        * Sets the indexes of the table. Each index over
+        * fields of the class gets a findBy method that
+        * looks records up by its columns.
+        * @param indexes a vector of PHPIndex.
+        * @return void
+        */
+        void setIndexes(const std::vector<PHPIndex> &indexes)
+        {
+            this->indexes = indexes;
+        }
+
+        /**
+        * Sets the optional parts of the generated class
+        * @param options PHPBuilderOptions
+        * @return void
+        */
+        void setOptions(const PHPBuilderOptions &options)
+        {
+            this->options = options;
+        }
+
+        /**
+        * Sets the templates that replace built-in methods.
+        * The set is only read, so one set can be shared by
+        * builders on several threads.
+        * @param templates PHPTemplateSet, null to use only built-in methods
+        * @return void
+        */
+        void setTemplates(const PHPTemplateSet *templates)
+        {
+            this->templates = templates;
+        }
+
+        /**
+        * Renders the template for a method if one was
+        * loaded. Returns false if the built-in method
+        * should be used instead.
+        * @param method PHPTemplateSet::Method
+        * @return bool
+        */
+        bool renderTemplate(PHPTemplateSet::Method method)
+        {
+            const PHPTemplate *t = this->templates != nullptr ? this->templates->get(method) : nullptr;
+            if(t == nullptr)
+            {
+                return false;
+            }
+            PHPTemplateModel model = {this->className, this->context.classNameLower, this->tableName, &this->Fields};
+            t->render(this->out, model);
+            return true;
+        }
+
+        /**
+        * Renders one part of the class from its template,
+        * or with the built-in method create if there is
+        * none, after writing message to the log. The part
+        * is recorded as a span named after the method if
+        * a trace buffer is set.
+        * @param method PHPTemplateSet::Method
+        * @param create PHPBuilder member function for the built-in code
+        * @param message string literal written to the log
+        * @return void
+        */
+        void renderPart(PHPTemplateSet::Method method, void (PHPBuilder::*create)(), const char *message)
+        {
+            int64_t start = this->trace != nullptr ? this->trace->now() : 0;
+            if(this->log != nullptr){*this->log << message;}
+            if(!this->renderTemplate(method)){(this->*create)();}
+            if(this->trace != nullptr){this->trace->add(PHPTemplateSet::getMethodName(method), "emit", start);}
+        }
+
+        /**
+        * Sets the stream progress messages are written
+        * to. Defaults to std::cout, null writes none.
+        * @param log ostream
+        * @return void
+        */
+        void setLog(std::ostream *log)
+        {
+            this->log = log;
+        }
+
+        /**
+        * Sets the buffer the spans of context building,
+        * each rendered part and the flush to disk are
+        * recorded into. Null, the default, records none.
+        * @param trace TraceBuffer
+        * @return void
+        */
+        void setTrace(TraceBuffer *trace)
+        {
+            this->trace = trace;
+        }
+
+        /**
+        * Builds the output file name from the output
+        * directory and the class name
+        * @return void
+        */
+        void updateFileName()
+        {
+            if(this->outputDirectory.empty())
+            {
+                this->fileName = std::string(this->className) + ".php";
+            }
+            else
+            {
+                this->fileName = (std::filesystem::path(this->outputDirectory) / (std::string(this->className) + ".php")).string();
+            }
         }
 
         /**
          * Getter
          * Retrieves the name of the class 
-         * @return string
+         * @return string_view
          */
-        std::string getClassName(){return this->className;}
+        std::string_view getClassName(){return this->className;}
 
         /**
          * Getter
          * Retrieves the fields 
-         * @return vector of strings
+         * @return vector of string_views
          */
-        std::vector<std::string>  getFields(){return this->Fields;}
+        const std::vector<std::string_view> &getFields(){return this->Fields;}
 
         /**
          * Getter
          * Retrieves the name of the table 
-         * @return string
+         * @return string_view
+         */
+        std::string_view getTableName(){return this->tableName;}
+
+        /**
+         * Getter
+         * Retrieves the columns keyset paging orders by before ID
+         * @return vector of string_views
+         */
+        const std::vector<std::string_view> &getSortKeys(){return this->sortKeys;}
+
+        /**
+         * Getter
+         * Retrieves the column marking soft deleted rows
+         * @return string_view
+         */
+        std::string_view getSoftDelete(){return this->softDelete;}
+
+        /**
+         * Getter
+         * Retrieves the columns of the primary key
+         * @return vector of string_views
+         */
+        const std::vector<std::string_view> &getPrimaryKey(){return this->primaryKey;}
+
+        /**
+         * Getter
+         * Retrieves the indexes of the table
+         * @return vector of PHPIndex
+         */
+        const std::vector<PHPIndex> &getIndexes(){return this->indexes;}
+
+        /**
+         * Getter
+         * Retrieves the class rendered by the last call to
+         * renderClass or createClassFile
+         * @return string_view
          */
-        std::string getTableName(){return this->tableName;}
+        std::string_view getOutput() const {return this->out.view();}
 
         /**
          * Getter
@@ -70,91 +461,465 @@ class PHPBuilder
          */
         std::string getFileName(){return this->fileName;}
 
-       /**
-        * Function that breaks a string with more than
-        * 70 characters into a vector of lines. If character
-        * 70 is not a space character, it is split at the first
-        * character before 70 that is a space. 
-        * @return void
-        */
-        std::vector<std::string> checkIfLineIsTooLong(std::string line)
-        {
-            std::vector<std::string> lines;
-            int i = 0;
-            int current = 0; 
-            int limit = 70;
-            if(line.size() > limit)
-            {
-                while(line.substr(i, -1).size() > limit)
-                { 
-                    current = i; 
-                    i = i + limit;
-                    while(line.at(i) != ' ')
-                    { 
-                        i = i - 1;
-                    }
-
-                    //std::cout << "i is " << i << "/n";
-                    lines.push_back(line.substr(current, i));
-                }
-                //skip the space by starting a character late
-                lines.push_back(line.substr(i+1, -1));
-            }
-            else 
-            {
-                lines.push_back(line.substr(i, -1));
-            }
-            return lines;
-        }
-
         /**
         * Function that writes a comment for a method
         * Writes a comment to be inserted above a class
         * method with the description, detailed description, 
-        * parameters and return type. 
+        * parameters and return type. The descriptions
+        * are wrapped at commentWidth characters.
+        * @param comment OutputBuffer to write into
         * @return void
         */
-        void createMethodComment(std::string Description, std::string DetailedDescription, 
-                        std::vector<std::pair<std::string, std::string>> Params,
-                        std::string returnType)
+        void createMethodComment(OutputBuffer &comment, std::string_view Description,
+                        std::string_view DetailedDescription, 
+                        const std::vector<std::pair<std::string_view, std::string_view>> &Params,
+                        std::string_view returnType)
         {
-            std::vector<std::string> DescriptionLines = checkIfLineIsTooLong(Description);
-            std::vector<std::string> DetailedDescriptionLines = checkIfLineIsTooLong(DetailedDescription);
+            comment.clear();
+            comment << "\t/**\n";
+            comment.writeWrapped(Description, this->commentWidth, "\t * ");
+            comment << "\t *\n";
+            for(const std::pair<std::string_view, std::string_view> &param : Params)
+            {
+                comment << "\t * @param " << param.first << " " << param.second << "\n";
+            }
+            comment.writeWrapped(DetailedDescription, this->commentWidth, "\t * ");
+            comment << "\t * @return " << returnType << "\n";
+            comment << "\t*/\n";
+        }
 
+        /**
+        * Function that writes a comment for a class
+        * Writes a comment to be inserted above a class,
+        * with the limits the batch methods share
+        * @return void
+        */
+        void createClassComment()
+        {
             this->out << "\t/**\n";
-            for(std::string l : DescriptionLines)
+            this->out << "\t * Class used to handle CRUD operations related to " 
+                     << this->context.plural << ". \n";
+            this->out << "\t *\n";
+            this->out.writeWrapped("The batch methods split their work into statements of up to $chunk "
+                    "objects or IDs, kept under 999 placeholders, the lowest default limit of the "
+                    "supported databases. Those that write run each statement in its own "
+                    "transaction unless one is already open and roll it back if it fails.", this->commentWidth, "\t * ");
+            this->out << "\t */\n";
+        } 
+
+        /**
+        * Builds the strings derived from the model
+        * that the methods share: the lower case and
+        * plural class names, the column and parameter
+        * lists, the insert SET and checkIfExists WHERE
+        * clauses and the wrapped method comments. Called
+        * once per class by createClassFile.
+        * @return void
+        */
+        void buildContext()
+        {
+            ModelContext &c = this->context;
+            c.classNameLower = this->stringToLower(this->className);
+            c.plural = c.classNameLower + "s";
+            c.columnList.clear();
+            c.columnArray.clear();
+            c.bindList.clear();
+            c.rowPlaceholders = "(";
+            c.newColumnList.clear();
+            c.newRowPlaceholders = "(";
+            c.setClause.clear();
+            c.whereClause.clear();
+            size_t length = 0;
+            for(std::string_view f : this->Fields)
             {
-                this->out << "\t * " << l << "\n";
+                length += f.size() + 2;
             }
-            this->out << "\t *\n";
-            if(Params.size() > 0)
+            c.columnList.reserve(length);
+            c.bindList.reserve(length + this->Fields.size());
+            c.setClause.reserve(length * 2 + this->Fields.size() * 4);
+            c.whereClause.reserve(length * 2 + this->Fields.size() * 24);
+            for(size_t i = 0; i < this->Fields.size(); i++)
             {
-                for(std::pair<std::string, std::string> param : Params)
+                std::string_view f = this->Fields[i];
+                bool last = i + 1 == this->Fields.size();
+                if(i > 0)
                 {
-                    this->out << "\t * @param " << param.first << " " << param.second << "\n";
+                    c.columnList += ", ";
+                    c.columnArray += ", ";
+                    c.bindList += ", ";
                 }
+                c.columnList += f;
+                c.columnArray += '"';
+                c.columnArray += f;
+                c.columnArray += '"';
+                c.bindList += ':';
+                c.bindList += f;
+                c.rowPlaceholders += i > 0 ? ", ?" : "?";
+                if(f != "ID")
+                {
+                    c.newRowPlaceholders += c.newColumnList.empty() ? "?" : ", ?";
+                    c.newColumnList += c.newColumnList.empty() ? "" : ", ";
+                    c.newColumnList += f;
+                }
+
+                //two column=:column pairs per line
+                if(i % 2 == 0){c.setClause += "\t\t\t\t";}
+                c.setClause += f;
+                c.setClause += "=:";
+                c.setClause += f;
+                c.setClause += last ? "\";\n" : (i % 2 == 0 ? ", " : ",\n");
+
+                c.whereClause += i == 0 ? "\t\t\t\tWHERE " : "\t\t\t\tAND ";
+                c.whereClause += f;
+                c.whereClause += " = \" . $this->";
+                c.whereClause += f;
+                c.whereClause += last ? " . \"\";\n" : " . \"\n";
+            }
+
+            c.rowPlaceholders += ')';
+            c.newRowPlaceholders += ')';
+            c.rowCasts.assign(this->Fields.size(), std::string());
+            for(size_t i = 0; i < this->Fields.size() && i < this->fieldTypes.size(); i++)
+            {
+                bool nullable = false;
+                std::string_view cast = this->getCast(this->fieldTypes[i], nullable);
+                if(cast.empty()){continue;}
+                std::string value = "$row['" + std::string(this->Fields[i]) + "']";
+                c.rowCasts[i] = nullable ? value + " === null ? null : " + std::string(cast) + value
+                                         : std::string(cast) + value;
             }
-            
-            for(std::string d : DetailedDescriptionLines)
+            c.liveCondition.clear();
+            if(!this->softDelete.empty())
             {
-                this->out << "\t * " << d << "\n";
+                c.liveCondition = std::string(this->softDelete) + " IS NULL";
+            }
+            c.selectList = c.columnList.empty() ? "*" : c.columnList;
+
+            //rows after (k1, k2, ID) are those with k1 > ? OR (k1 = ? AND k2 > ?) OR ...
+            //with a leading k1 >= ? so the database can seek on an index over k1
+            c.keyColumns = this->sortKeys;
+            if(std::find(c.keyColumns.begin(), c.keyColumns.end(), "ID") == c.keyColumns.end())
+            {
+                c.keyColumns.push_back("ID");
+            }
+            c.keysetWhere.clear();
+            c.keysetOrder.clear();
+            c.keysetBindings.clear();
+            if(c.keyColumns.size() > 1)
+            {
+                c.keysetWhere = std::string(c.keyColumns[0]) + " >= ? AND (";
+                c.keysetBindings.push_back(c.keyColumns[0]);
+            }
+            for(size_t i = 0; i < c.keyColumns.size(); i++)
+            {
+                if(i > 0)
+                {
+                    c.keysetWhere += " OR ";
+                    c.keysetOrder += ", ";
+                }
+                if(i > 0){c.keysetWhere += '(';}
+                for(size_t j = 0; j < i; j++)
+                {
+                    c.keysetWhere += c.keyColumns[j];
+                    c.keysetWhere += " = ? AND ";
+                    c.keysetBindings.push_back(c.keyColumns[j]);
+                }
+                c.keysetWhere += c.keyColumns[i];
+                c.keysetWhere += " > ?";
+                if(i > 0){c.keysetWhere += ')';}
+                c.keysetBindings.push_back(c.keyColumns[i]);
+                c.keysetOrder += c.keyColumns[i];
+                c.keysetOrder += " ASC";
+            }
+            if(c.keyColumns.size() > 1){c.keysetWhere += ')';}
+
+            const std::string &lower = c.classNameLower;
+            this->createMethodComment(c.comments[PHPTemplateSet::Constructor],
+                    "Constructor to create an " + lower + " object.",
+                    "Creates " + std::string(this->className) + " object by setting the $conn to a PDO object",
+                    {{"PDO", "$db a configured pdo connection obj"}}, "Article");
+            this->createMethodComment(c.comments[PHPTemplateSet::CountApprox],
+                    "Estimates the number of records in the " + lower + " table.",
+                    "Reads the row count the database keeps in its table statistics instead of "
+                    "counting the rows: sqlite_stat1 on SQLite, which is filled by ANALYZE, "
+                    "information_schema on MySQL and pg_class on PostgreSQL. The estimate can be "
+                    "off by the rows changed since the statistics were gathered"
+                    + std::string(this->softDelete.empty() ? "" : " and includes soft deleted records")
+                    + ". Falls back to count when the database has no estimate.",
+                    {}, "int");
+            this->createMethodComment(c.comments[PHPTemplateSet::CountCached],
+                    "Retrieves the number of records in the " + lower + " table from a cache.",
+                    "Returns the result of count, or of countApprox when $approximate is true, "
+                    "remembered for $ttl seconds per connection in a static cache shared by every "
+                    + lower + " object. Records added or removed within that time are not counted.",
+                    {{"int", "$ttl seconds a count is kept"},
+                     {"bool", "$approximate cache countApprox instead of count"}},
+                    "int");
+            this->createMethodComment(c.comments[PHPTemplateSet::CheckIfExists],
+                    "Checks if an " + lower + " object exists in the database.",
+                    "Prepares and executes a simple Select count statement"
+                    "to see if there are multiple" + lower + "records with the same fields",
+                    {}, "bool");
+            this->createMethodComment(c.comments[PHPTemplateSet::ExistsMany],
+                    "Checks which of many " + lower + " objects exist in the database.",
+                    "Unlike checkIfExists, ID is left out of the comparison unless it is the only "
+                    "field, so objects not yet inserted can be looked up. Returns an array with the "
+                    "keys of $objects holding true for each object with a matching record, or false "
+                    "if a statement fails.",
+                    {{"PDO", "$db a configured pdo connection obj"},
+                     {"array", "$objects " + std::string(this->className) + " objects to look up"},
+                     {"int", "$chunk maximum number of objects per statement"}},
+                    "array|false");
+            this->createMethodComment(c.comments[PHPTemplateSet::Read],
+                    "Retrieves all records from " + c.plural + " view.",
+                    "Prepares and executes a simple Select statement to retrieve all records in the "
+                    + lower + " view.",
+                    {}, "PDOStatement");
+            this->createMethodComment(c.comments[PHPTemplateSet::ReadColumns],
+                    "Retrieves chosen columns of all records from " + c.plural + " view.",
+                    "Prepares and executes a Select statement retrieving only the given columns "
+                    "of all records in the " + lower + " view. Every column must be one of "
+                    "COLUMNS; an InvalidArgumentException is thrown otherwise.",
+                    {{"array", "$cols names of the columns to retrieve"}}, "PDOStatement");
+            this->createMethodComment(c.comments[PHPTemplateSet::ReadOne],
+                    "Retrieves one " + lower + " record by ID",
+                    "Prepares and executes a simple Select statement "
+                    "retrieving all values for one record and updates the " + lower + " object.",
+                    {}, "void");
+            this->createMethodComment(c.comments[PHPTemplateSet::ReadPaging],
+                    "Retrieves a certain number of records from " + lower + " view.",
+                    "Prepares and executes a simple Select statement to retrieve records starting "
+                    "from an id to a certain id in the " + lower + " view.",
+                    {{"int", "$from_record_num first record to display"},
+                     {"int", "$records_per_page total number of records to retrieve"}},
+                    "PDOStatement");
+            if(c.keyColumns.size() == 1)
+            {
+                this->createMethodComment(c.comments[PHPTemplateSet::ReadAfter],
+                        "Retrieves the records from " + lower + " view that come after an ID.",
+                        "Prepares and executes a Select statement retrieving up to $limit records "
+                        "ordered by ID that follow $lastId. Pass the ID of the last record of a page "
+                        "to get the next one, or null for the first page. Unlike readPaging the cost "
+                        "does not grow with how deep the page is.",
+                        {{"mixed", "$lastId ID of the last record already read, null for the first page"},
+                         {"int", "$limit number of records to retrieve"}},
+                        "PDOStatement");
+            }
+            else
+            {
+                std::string keys;
+                for(std::string_view k : c.keyColumns)
+                {
+                    keys += keys.empty() ? "" : ", ";
+                    keys += k;
+                }
+                this->createMethodComment(c.comments[PHPTemplateSet::ReadAfter],
+                        "Retrieves the records from " + lower + " view that come after a key.",
+                        "Prepares and executes a Select statement retrieving up to $limit records "
+                        "ordered by " + keys + " that follow $lastKey. Pass the last record of a "
+                        "page to get the next one, or null for the first page. Unlike readPaging "
+                        "the cost does not grow with how deep the page is.",
+                        {{"array", "$lastKey " + keys + " of the last record already read, null for the first page"},
+                         {"int", "$limit number of records to retrieve"}},
+                        "PDOStatement");
+            }
+            this->createMethodComment(c.comments[PHPTemplateSet::Iterate],
+                    "Iterates over every " + lower + " record without loading them all.",
+                    "Reads the records in pages of $batch with readAfter and yields them one at a "
+                    "time as " + std::string(this->className) + " objects, so at most one page is "
+                    "held in memory. With $reuse every record is loaded into the same object, "
+                    "which must not be kept between iterations; otherwise each record is a new "
+                    "object. With $unbuffered on MySQL the records are streamed by one unbuffered "
+                    "query instead of pages, and the connection cannot run other queries until "
+                    "the iteration ends.",
+                    {{"int", "$batch number of records read per query"},
+                     {"bool", "$reuse load every record into the same object"},
+                     {"bool", "$unbuffered stream one unbuffered query on MySQL"}},
+                    "Generator");
+            //fields are only converted when the model declares types they have casts for
+            bool converted = std::any_of(c.rowCasts.begin(), c.rowCasts.end(),
+                                         [](const std::string &cast){return !cast.empty();});
+            std::string conversion = converted ? ", converting each field to the type declared in the model" : "";
+            this->createMethodComment(c.comments[PHPTemplateSet::Hydrate],
+                    "Creates one " + lower + " object from a row.",
+                    "Copies the columns of a row fetched with PDO::FETCH_ASSOC into a new "
+                    + std::string(this->className) + " object on the same connection" + conversion
+                    + ". The row becomes the snapshot update compares against.",
+                    {{"array", "$row row fetched with PDO::FETCH_ASSOC"}},
+                    "static");
+            this->createMethodComment(c.hydrateAllComment,
+                    "Creates " + lower + " objects from every row of a statement.",
+                    "Fetches the remaining rows of an executed statement, such as the one returned "
+                    "by read or readPaging, and copies each into a clone of one new "
+                    + std::string(this->className) + " object" + conversion + ".",
+                    {{"PDOStatement", "$s executed statement selecting the class's columns"}},
+                    "array");
+            this->createMethodComment(c.comments[PHPTemplateSet::Count],
+                    "Retrieves the total number of records in " + lower + " view.",
+                    "Prepares and executes a simple Select statement "
+                    "retreiving the count for all rows in the " + lower + " view.",
+                    {}, "int");
+            this->createMethodComment(c.comments[PHPTemplateSet::Insert],
+                    "Inserts a record into the " + lower + " table.",
+                    "Inserts a record into the " + lower + " table using currently set properties in "
+                    + lower + " object. If successful returns true.",
+                    {}, "bool");
+            this->createMethodComment(c.comments[PHPTemplateSet::InsertMany],
+                    "Inserts many records into the " + lower + " table.",
+                    "Objects with an ID are inserted with it in multi-row statements; the others "
+                    "are given the ID the database generates, one row at a time on MySQL. Returns "
+                    "the IDs of all objects in order, or false if a statement fails.",
+                    {{"PDO", "$db a configured pdo connection obj"},
+                     {"array", "$objects " + std::string(this->className) + " objects to insert"},
+                     {"int", "$chunk maximum number of rows per statement"}},
+                    "array|false");
+            this->createMethodComment(c.comments[PHPTemplateSet::StatementCache],
+                    "Returns the prepared statement of a method.",
+                    "Prepares the query the first time a method runs on a connection and returns "
+                    "the same statement on later calls, so only new values are sent. Statements "
+                    "are kept per connection and method in a static cache shared by every "
+                    + lower + " object. Set $cacheStatements to false to prepare on every call, "
+                    "e.g. when the driver emulates prepares and nothing would be saved.",
+                    {{"string", "$method name of the statement, usually the calling method"},
+                     {"string", "$query query of the method"}},
+                    "PDOStatement");
+            this->createMethodComment(c.comments[PHPTemplateSet::Update],
+                    "Updates a record in sources " + lower + " table using currently  set properties in "
+                    + lower + " object.",
+                    "Updates a record in the " + lower + " table using currently set properties in "
+                    + lower + " object for a given id. Only the columns that changed since the record "
+                    "was read by readOne or iterate or last updated are written, as bound parameters; "
+                    "when none changed no query is run. If successful returns true.",
+                    {{"int",  "ID Integer for ID to update"}}, "bool");
+            if(this->softDelete.empty())
+            {
+                this->createMethodComment(c.comments[PHPTemplateSet::Remove],
+                        "Removes a record in " + lower + " by ID",
+                        "Prepares and executes a query to delete the record in the "
+                        + lower + " table with the ID of this object. If successful, returns true.",
+                        {}, "bool");
+                this->createMethodComment(c.comments[PHPTemplateSet::RemoveMany],
+                        "Removes many records in " + lower + " by ID.",
+                        "Deletes the records with the given IDs. Returns the number of records "
+                        "deleted, or false if a statement fails.",
+                        {{"PDO", "$db a configured pdo connection obj"},
+                         {"array", "$ids IDs of the records to remove"},
+                         {"int", "$chunk maximum number of IDs per statement"}},
+                        "int|false");
+            }
+            else
+            {
+                this->createMethodComment(c.comments[PHPTemplateSet::Remove],
+                        "Removes a record in " + lower + " by ID",
+                        "Marks the record in the " + lower + " table with the ID of this object as "
+                        "deleted by setting " + std::string(this->softDelete) + " to the current time. "
+                        "The read methods leave out marked records. If successful, returns true.",
+                        {}, "bool");
+                this->createMethodComment(c.comments[PHPTemplateSet::RemoveMany],
+                        "Removes many records in " + lower + " by ID.",
+                        "Marks the records with the given IDs as deleted by setting "
+                        + std::string(this->softDelete) + " to the current time. Returns the number "
+                        "of records marked, or false if a statement fails.",
+                        {{"PDO", "$db a configured pdo connection obj"},
+                         {"array", "$ids IDs of the records to remove"},
+                         {"int", "$chunk maximum number of IDs per statement"}},
+                        "int|false");
+            }
+            c.finders.clear();
+            if(!this->primaryKey.empty())
+            {
+                this->addFinder("primary key", true, this->primaryKey);
+            }
+            for(const PHPIndex &index : this->indexes)
+            {
+                this->addFinder(index.name, index.unique, index.columns);
             }
-            this->out << "\t * @return " << returnType << "\n";
-            this->out << "\t*/\n";
         }
 
         /**
-        * Function that writes a comment for a class
-        * Writes a comment to be inserted above a class
+        * Adds the findBy method of an index to the context.
+        * Indexes over ID alone are left out as readOne
+        * covers them, as are indexes over columns that are
+        * not fields and indexes whose columns already have
+        * a method.
+        * @param name string_view of the index
+        * @param unique bool
+        * @param columns vector of string_views in index order
         * @return void
         */
-        void createClassComment()
+        void addFinder(std::string_view name, bool unique, const std::vector<std::string_view> &columns)
         {
-            this->out << "\t/**\n";
-            this->out << "\t * Class used to handle CRUD operations related to " 
-                     << this->stringToLower(this->className) << "s. \n";
-            this->out << "\t */\n";
-        } 
+            ModelContext &c = this->context;
+            if(columns.empty() || (columns.size() == 1 && columns[0] == "ID"))
+            {
+                return;
+            }
+            ModelFinder finder;
+            finder.name = "findBy";
+            finder.unique = unique;
+            std::vector<std::string> texts;
+            std::string columnText;
+            for(size_t i = 0; i < columns.size(); i++)
+            {
+                std::string_view column = columns[i];
+                if(std::find(this->Fields.begin(), this->Fields.end(), column) == this->Fields.end())
+                {
+                    return;
+                }
+                if(i > 0)
+                {
+                    finder.name += "And";
+                    finder.parameters += ", ";
+                    finder.whereClause += " AND ";
+                    columnText += i + 1 == columns.size() ? " and " : ", ";
+                }
+                finder.name += static_cast<char>(toupper(static_cast<unsigned char>(column[0])));
+                finder.name += column.substr(1);
+                //the method's own variables keep their names
+                std::string parameter = "$" + std::string(column);
+                if(column == "query" || column == "stmt" || column == "row" || column == "this")
+                {
+                    parameter += "Value";
+                }
+                finder.parameters += parameter;
+                finder.whereClause += std::string(column) + " = ?";
+                columnText += column;
+                texts.push_back(parameter + " value of " + std::string(column));
+            }
+            for(const ModelFinder &f : c.finders)
+            {
+                if(f.name == finder.name)
+                {
+                    return;
+                }
+            }
+            std::vector<std::pair<std::string_view, std::string_view>> params;
+            for(const std::string &text : texts)
+            {
+                params.push_back({"mixed", text});
+            }
+            std::string lower = c.classNameLower;
+            std::string index = std::string(name) + (name == "primary key" ? "" : " index");
+            std::string match = columns.size() == 1 ? " matches the given value" : " match the given values";
+            if(unique)
+            {
+                this->createMethodComment(finder.comment,
+                        "Retrieves the " + lower + " record with the given " + columnText + ".",
+                        "Reads the record whose " + columnText + match + ", which the unique " + index + " of the table finds without a scan. Returns null if "
+                        "there is no such record.",
+                        params, std::string(this->className) + "|null");
+            }
+            else
+            {
+                this->createMethodComment(finder.comment,
+                        "Retrieves the " + lower + " records with the given " + columnText + ".",
+                        "Reads the records whose " + columnText + match + ", which the "
+                        + index + " of the table finds without a scan. Returns an empty array if "
+                        "there are none.",
+                        params, "array");
+            }
+            c.finders.push_back(std::move(finder));
+        }
 
         /**
         * Writes onstructor for the PHP file
@@ -164,17 +929,7 @@ class PHPBuilder
         */
         void createConstructor()
         {
-            std::string Description = "Constructor to create an " 
-                                    + this->stringToLower(this->className) 
-                                    + " object.";
-            std::vector<std::pair<std::string, std::string>> Params = { 
-                                    std::make_pair("PDO", "$db a configured pdo connection obj")
-                                    };
-            std::string DetailedDescription = "Creates "
-                                             + this->className 
-                                             + " object by setting the $conn to a PDO object";
-            std::string returnType = "Article";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
+            this->out << this->context.comments[PHPTemplateSet::Constructor].view();
             this->out << "\t\tpublic function __construct($db)\n";
             this->out << "\t\t{\n";
             this->out <<"\t\t\t$this->conn = $db;\n";
@@ -191,42 +946,12 @@ class PHPBuilder
         */
         void createCheckIfExists()
         {
-            std::string Description = "Checks if an " 
-                                    + this->stringToLower(this->className) 
-                                    + " object exists in the database.";
-            std::vector<std::pair<std::string, std::string>> Params = {};
-            std::string DetailedDescription = "Prepares and executes a simple Select count statement"
-                                             "to see if there are multiple"
-                                            + this->stringToLower(this->className) 
-                                            + "records with the same fields";
-            std::string returnType = "bool";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
+            this->out << this->context.comments[PHPTemplateSet::CheckIfExists].view();
             this->out << "\t\tpublic function checkIfExists() : bool\n";
             this->out << "\t\t{\n";
             this->out << "\t\t\t$query = \"SELECT Count(*) as count\n"; 
             this->out << "\t\t\t\t FROM \" . $this->table_name . \"\n";
-            bool first = true; 
-            int i = 0; 
-            for (std::string f : this->Fields)
-            {
-                if(first){
-                    this->out << "\t\t\t\tWHERE " << f << " = \" . $this->" << f << " . \"";
-                }else
-                {
-                    this->out << "\t\t\t\tAND " << f << " = \" . $this->" << f << " . \"";
-                }
-                i++;
-                if(i == this->Fields.size())
-                {
-                    this->out << "\";\n";
-                }
-                else
-                {
-                    this->out << "\n";
-                }
-                
-                first = false; 
-            }
+            this->out << this->context.whereClause;
             this->out << "\n";
             this->out << "\t\t\t//prepare query\n";
             this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
@@ -242,61 +967,141 @@ class PHPBuilder
         }
 
         /**
-        * Writes a PHP function to check if a record
-        * exists and retrieves the fields
-        * Writes comments and GetIfExists function 
-        * for the output PHP file 
+        * Writes a PHP function to check which of many
+        * objects exist
+        * Writes comments and a static existsMany function
+        * that looks up a batch of objects per query. Each
+        * object adds one SELECT ? AS n, EXISTS (...) term
+        * to a UNION ALL, binding its position in the batch
+        * and its fields, so the database decides every
+        * match with the same = comparison checkIfExists
+        * uses. ID is left out of the comparison unless it
+        * is the only field.
         * @return void
         */
-        void createGetIfExists()
+        void createExistsMany()
         {
-            std::string Description = "Checks if an " 
-                                    + this->stringToLower(this->className) 
-                                    + " object exists in the database using currently set properties.";
-            std::vector<std::pair<std::string, std::string>> Params = {};
-            std::string DetailedDescription = "Prepares and executes a simple Select statement that"
-                                              " retrieves an "
-                                            + this->stringToLower(this->className) 
-                                            + " object from the database with currently set properties";
-            std::string returnType = "bool";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
-            this->out << "\t\tpublic function checkIfExists() : bool\n";
+            std::vector<std::string_view> columns;
+            for(std::string_view f : this->Fields)
+            {
+                if(f == "ID" && this->Fields.size() > 1){continue;}
+                columns.push_back(f);
+            }
+            std::string condition;
+            for(size_t i = 0; i < columns.size(); i++)
+            {
+                if(i > 0){condition += " AND ";}
+                condition += columns[i];
+                condition += " = ?";
+            }
+            //one ? for the position and one per field, and SQLite allows 500 terms per UNION
+            size_t maxRows = std::min<size_t>(500, std::max<size_t>(1, 999 / (columns.size() + 1)));
+            this->out << this->context.comments[PHPTemplateSet::ExistsMany].view();
+            this->out << "\t\tpublic static function existsMany(PDO $db, array $objects, int $chunk = 500)\n";
             this->out << "\t\t{\n";
-            this->out << "\t\t\t$query = \"SELECT *\n"; 
-            this->out << "\t\t\t\t FROM \" . $this->table_name . \"\n";
-
-            bool first = true; 
-            int i = 0; 
-            for (std::string f : this->Fields)
+            this->out << "\t\t\t// " << std::to_string(columns.size() + 1) << " placeholders per object, at most 999 per statement\n";
+            this->out << "\t\t\t$rowsPerStatement = max(1, min($chunk, " << std::to_string(maxRows) << "));\n";
+            this->out << "\t\t\t$matches = array_fill_keys(array_keys($objects), false);\n";
+            this->out << "\t\t\tforeach(array_chunk($objects, $rowsPerStatement, true) as $rows)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$query = implode(\" UNION ALL \", array_fill(0, count($rows),\n";
+            this->out << "\t\t\t\t\t\"SELECT ? AS n, EXISTS (SELECT 1 FROM " << this->tableName << " WHERE " << condition << ") AS e\"));\n";
+            this->out << "\t\t\t\t$keys = array_keys($rows);\n";
+            this->out << "\t\t\t\t$values = [];\n";
+            this->out << "\t\t\t\tforeach($keys as $i => $n)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$values[] = $i;\n";
+            for(std::string_view f : columns)
             {
-                if(first){
-                    this->out << "\t\t\t\tWHERE " << f << " = \" . $this->" << f << " . \"";
-                }else
-                {
-                    this->out << "\t\t\t\tAND " << f << " = \" . $this->" << f << " . \"";
-                }
-                i++;
-                if(i == this->Fields.size())
-                {
-                    this->out << "\";\n";
-                }
-                else
-                {
-                    this->out << "\n";
-                }
-                
-                first = false; 
+                this->out << "\t\t\t\t\t$values[] = $rows[$n]->" << f << ";\n";
             }
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\t$stmt = $db->prepare($query);\n";
+            this->out << "\t\t\t\tif($stmt === false || !$stmt->execute($values))\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\treturn false;\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\t//n is the position of the object in this batch\n";
+            this->out << "\t\t\t\twhile(($row = $stmt->fetch(PDO::FETCH_NUM)) !== false)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$matches[$keys[(int)$row[0]]] = (bool)$row[1];\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\treturn $matches;\n";
+            this->out << "\t\t}\n";
             this->out << "\n";
-            this->out << "\t\t\t//prepare query\n";
+        }
+
+        /**
+        * Writes the statement preparation of a method.
+        * Without the statement cache option the given line
+        * is written as is; with it the statement is taken
+        * from prepareCached instead. Only methods that read
+        * all results of their statement before returning
+        * may use it, as a cached statement is reset when it
+        * is handed out again.
+        * @param key PHP expression naming the statement, e.g. "read" in quotes
+        * @param line PHP line that prepares $query on $this->conn
+        * @return void
+        */
+        void prepareQuery(std::string_view key, std::string_view line)
+        {
+            if(this->options.statementCache)
+            {
+                this->out << "\t\t\t$stmt = $this->prepareCached(" << key << ", $query);\n";
+            }
+            else
+            {
+                this->out << line;
+            }
+        }
+
+        /**
+        * Writes the line setting $key to the key of a
+        * per-connection cache entry, the id of the
+        * connection followed by suffix. PHP reuses the id
+        * of a freed object, so every cache entry must keep
+        * its connection alive: a cached statement does by
+        * itself and a cached count stores the connection.
+        * @param suffix PHP expression appended to the id
+        * @return void
+        */
+        void createConnectionKey(std::string_view suffix)
+        {
+            this->out << "\t\t\t//the cache entry keeps its connection alive, so the id is not reused\n";
+            this->out << "\t\t\t$key = spl_object_id($this->conn) . " << suffix << ";\n";
+        }
+
+        /**
+        * Function that writes the statement cache used by
+        * the statement cache option
+        * Writes comments and a prepareCached function that
+        * keeps one prepared statement per connection and
+        * method in a static array, closing the cursor of a
+        * reused statement before handing it out again.
+        * @return void
+        */
+        void createStatementCache()
+        {
+            this->out << this->context.comments[PHPTemplateSet::StatementCache].view();
+            this->out << "\t\tprivate function prepareCached($method, $query)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\tif(!self::$cacheStatements)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\treturn $this->conn->prepare($query);\n";
+            this->out << "\t\t\t}\n";
+            this->createConnectionKey("\":\" . $method");
+            this->out << "\t\t\tif(isset(self::$statements[$key]))\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\tself::$statements[$key]->closeCursor();\n";
+            this->out << "\t\t\t\treturn self::$statements[$key];\n";
+            this->out << "\t\t\t}\n";
             this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
-            this->out << "\t\t\t$stmt->execute();\n";
-            this->out << "\t\t\t$row = $stmt->fetch(PDO::FETCH_ASSOC);\n";
-            this->out << "\t\t\tif($row['count'] > 0)\n";
+            this->out << "\t\t\tif($stmt !== false)\n";
             this->out << "\t\t\t{\n";
-            this->out << "\t\t\t\treturn true;\n";
+            this->out << "\t\t\t\tself::$statements[$key] = $stmt;\n";
             this->out << "\t\t\t}\n";
-            this->out << "\t\t\treturn false;\n";
+            this->out << "\t\t\treturn $stmt;\n";
             this->out << "\t\t}\n";
             this->out << "\n";
         }
@@ -310,7 +1115,7 @@ class PHPBuilder
         */
         void createBindings()
         {
-            for(std::string f: this->Fields)
+            for(std::string_view f: this->Fields)
             {
                 this->out << "\t\t\t$stmt->bindParam(\":"<< f << "\", $this->" << f << ");\n"; 
             }
@@ -319,16 +1124,72 @@ class PHPBuilder
         /**
         * Function that assigns properties from query
         * results
-        * Loops through fields and sets the class properties
-        * to the row results of a sql squery
+        * Converts the fields of $row to their declared
+        * types, sets the object's properties to them and
+        * keeps $row as the object's snapshot
+        * @param object PHP variable of the object, e.g. $this
+        * @param indent tabs written before every line
         * @return void
         */
-        void setObjectPropertiesFromQuery()
+        void setObjectPropertiesFromQuery(std::string_view object, std::string_view indent)
         {
-            for(std::string f: this->Fields)
+            const ModelContext &c = this->context;
+            for(size_t i = 0; i < this->Fields.size(); i++)
+            {
+                if(!c.rowCasts[i].empty())
+                {
+                    this->out << indent << "$row['" << this->Fields[i] << "'] = " << c.rowCasts[i] << ";\n";
+                }
+            }
+            for(std::string_view f: this->Fields)
+            {
+                this->out << indent << object << "->" << f << " = $row['" << f << "'];\n";
+            }
+            this->out << indent << object << "->snapshot = $row;\n";
+        }
+
+        /**
+        * Finds the PHP cast for a declared property type.
+        * Handles int, float, bool and string, optionally
+        * nullable as ?int or int|null. Other types and
+        * unions of several types have no cast.
+        * @param type string_view as declared, e.g. ?int
+        * @param nullable set to true when the type allows null
+        * @return string_view cast such as (int), empty for none
+        */
+        std::string_view getCast(std::string_view type, bool &nullable)
+        {
+            std::string lower = this->stringToLower(type);
+            std::string_view rest = lower;
+            if(!rest.empty() && rest.front() == '?')
+            {
+                nullable = true;
+                rest.remove_prefix(1);
+            }
+            std::string_view base;
+            while(!rest.empty())
             {
-                this->out << "\t\t\t$this->" << f << " = $row['" << f << "'];\n";
+                size_t end = std::min(rest.find('|'), rest.size());
+                std::string_view part = rest.substr(0, end);
+                rest.remove_prefix(std::min(end + 1, rest.size()));
+                if(part == "null")
+                {
+                    nullable = true;
+                }
+                else if(base.empty())
+                {
+                    base = part;
+                }
+                else
+                {
+                    return {};
+                }
             }
+            if(base == "int"){return "(int)";}
+            if(base == "float"){return "(float)";}
+            if(base == "bool"){return "(bool)";}
+            if(base == "string"){return "(string)";}
+            return {};
         }
 
         /**
@@ -341,171 +1202,513 @@ class PHPBuilder
         void sanitizeFields()
         {
             this->out << "\t\t\t//Santize\n";
-            for(std::string f: this->Fields)
+            for(std::string_view f: this->Fields)
+            {
+                this->out << "\t\t\t$this->" << f << "=htmlspecialchars(strip_tags($" << f << "));\n";
+            }
+        }
+
+        /**
+        * Function that writes a read function to 
+        * retrieve all records
+        * Writes comments and function to read all 
+        * records from the class's table
+        * @return void
+        */
+        void createRead()
+        {
+            this->out << this->context.comments[PHPTemplateSet::Read].view();
+            this->out << "\t\t//Selects all records\n";
+            this->out << "\t\tpublic function read()\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t$query = \"SELECT " << this->context.selectList << "\n";
+            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n"; 
+            this->writeLiveWhere();
+            this->out << "\t\t\t\t ORDER BY ID ASC\";\n"; 
+            this->out << "\n";
+            this->out << "\t\t\t//prepare query\n";
+            //the statement is returned, so it is never cached and reset under its reader
+            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
+            this->out << "\n";
+            this->out << "\t\t\t//execute\n";
+            this->out << "\t\t\t$stmt->execute();\n";
+            this->out << "\n";
+            this->out << "\t\t\treturn $stmt;\n";
+            this->out << "\t\t}";
+            this->out << "\n";
+            this->out << "\n";
+        }
+
+        /**
+        * Function that writes a read function that
+        * retrieves chosen columns of all records
+        * Writes comments and function to read all records
+        * from the class's table with only the columns the
+        * caller asks for. The columns are checked against
+        * the COLUMNS constant before they are put into the
+        * query.
+        * @return void
+        */
+        void createReadColumns()
+        {
+            this->out << this->context.comments[PHPTemplateSet::ReadColumns].view();
+            this->out << "\t\tpublic function readColumns(array $cols)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t//only known columns may be put into the query\n";
+            this->out << "\t\t\t$unknown = array_diff($cols, self::COLUMNS);\n";
+            this->out << "\t\t\tif(count($cols) == 0 || count($unknown) > 0)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\tthrow new InvalidArgumentException(\"Unknown columns: \" . implode(\", \", $unknown));\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\t$list = implode(\", \", $cols);\n";
+            this->out << "\t\t\t$query = \"SELECT \" . $list . \"\n";
+            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n";
+            this->writeLiveWhere();
+            this->out << "\t\t\t\t ORDER BY ID ASC\";\n";
+            this->out << "\n";
+            this->out << "\t\t\t//prepare query\n";
+            //returned to the caller like read's, and one per column list
+            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
+            this->out << "\n";
+            this->out << "\t\t\t//execute\n";
+            this->out << "\t\t\t$stmt->execute();\n";
+            this->out << "\n";
+            this->out << "\t\t\treturn $stmt;\n";
+            this->out << "\t\t}\n";
+            this->out << "\n";
+        }
+
+        /**
+        * Function that writes a read one function to 
+        * retrieve a record by an ID
+        * Writes comments and function to read one 
+        * record from the class's table with the
+        * class's id. 
+        * @return void
+        */
+        void createReadOne()
+        {
+            this->out << this->context.comments[PHPTemplateSet::ReadOne].view();
+            this->out << "\t\tpublic function readOne() : void\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t//query to read single record\n";
+            this->out << "\t\t\t$query = \"SELECT " << this->context.selectList << "\n";
+            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n"; 
+            this->out << "\t\t\t\tWHERE ID = ?";
+            if(!this->context.liveCondition.empty())
+            {
+                this->out << " AND " << this->context.liveCondition;
+            }
+            this->out << "\n"; 
+            this->out << "\t\t\t\tLIMIT 1\";\n"; 
+            this->out << "\n";
+            this->out << "\t\t\t//prepare query\n";
+            this->prepareQuery("\"readOne\"", "\t\t\t$stmt = $this->conn->prepare($query);\n");
+            this->out << "\n";
+            this->out << "\t\t\t//bind id of product to be updated\n";
+            this->out << "\t\t\t$stmt->bindParam(1, $this->ID);\n"; 
+            this->out << "\n";
+            this->out << "\t\t\t//execute query\n";
+            this->out << "\t\t\t$stmt->execute();\n";
+            this->out << "\n";
+            this->out << "\t\t\t//get retrieved row\n";
+            this->out << "\t\t\t$row = $stmt->fetch(PDO::FETCH_ASSOC);\n";
+            this->out << "\t\t\tif($row === false)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$this->snapshot = [];\n";
+            this->out << "\t\t\t\treturn;\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\n";
+            this->out << "\t\t\t//the snapshot lets update write only what changes\n";
+            this->setObjectPropertiesFromQuery("$this", "\t\t\t");
+            this->out << "\t\t}";
+            this->out << "\n";
+            this->out << "\n";
+        }
+
+        /**
+        * Function that writes a read paging function to 
+        * retrieve records in certain amounts
+        * Writes comments and function to read specific
+        * amounts of retrieved records from the class's
+        * table  
+        * @return void
+        */
+        void createReadPaging()
+        {
+            this->out << this->context.comments[PHPTemplateSet::ReadPaging].view();
+            this->out << "\t\tpublic function readPaging($from_record_num, $records_per_page)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t// select query\n";
+            this->out << "\t\t\t$query = \"SELECT " << this->context.selectList << "\n";
+            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n";
+            this->writeLiveWhere();
+            this->out << "\t\t\t\tORDER BY ID ASC\n";
+            this->out << "\t\t\t\tLIMIT ?, ?\";";
+            this->out << "\n";
+            this->out << "\t\t\t// prepare query statement\n";
+            //returned to the caller like read's
+            this->out << "\t\t\t$stmt = $this->conn->prepare( $query );\n;";
+            this->out << "\n";
+            this->out << "\t\t\t// bind variable values\n";
+            this->out << "\t\t\t$stmt->bindParam(1, $from_record_num, PDO::PARAM_INT);\n";
+            this->out << "\t\t\t$stmt->bindParam(2, $records_per_page, PDO::PARAM_INT);\n";
+            this->out << "\n";
+            this->out << "\t\t\t// execute query\n";
+            this->out << "\t\t\t$stmt->execute();\n";
+            this->out << "\n";
+            this->out << "\t\t\t// return values from database\n";
+            this->out << "\t\t\treturn $stmt;\n";
+            this->out << "\t\t}\n";
+            this->out << "\n";
+        }
+
+        /**
+        * Function that writes a keyset paging function
+        * to retrieve the records following a key
+        * Writes comments and function to read a page of
+        * records from the class's table that come after
+        * the last record of the previous page, ordered by
+        * the sort_key columns and ID. Each page is found
+        * with an index seek instead of skipping an offset.
+        * @return void
+        */
+        void createReadAfter()
+        {
+            const ModelContext &c = this->context;
+            std::string_view last = c.keyColumns.size() == 1 ? "$lastId" : "$lastKey";
+            this->out << c.comments[PHPTemplateSet::ReadAfter].view();
+            this->out << "\t\tpublic function readAfter(" << last << ", $limit)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t// select query, starting after the last key unless this is the first page\n";
+            if(c.liveCondition.empty())
+            {
+                this->out << "\t\t\t$where = " << last << " === null ? \"\" : \"WHERE " << c.keysetWhere << "\";\n";
+            }
+            else
+            {
+                this->out << "\t\t\t$where = " << last << " === null ? \"WHERE " << c.liveCondition << "\" : \"WHERE "
+                          << c.liveCondition << " AND " << c.keysetWhere << "\";\n";
+            }
+            this->out << "\t\t\t$query = \"SELECT " << this->context.selectList << "\n";
+            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n";
+            this->out << "\t\t\t\t\" . $where . \"\n";
+            this->out << "\t\t\t\tORDER BY " << c.keysetOrder << "\n";
+            this->out << "\t\t\t\tLIMIT ?\";\n";
+            this->out << "\n";
+            this->out << "\t\t\t// prepare query statement\n";
+            //returned to the caller and read by iterate while other pages may be read
+            this->out << "\t\t\t$stmt = $this->conn->prepare( $query );\n";
+            this->out << "\n";
+            this->out << "\t\t\t// bind variable values\n";
+            this->out << "\t\t\t$i = 1;\n";
+            this->out << "\t\t\tif(" << last << " !== null)\n";
+            this->out << "\t\t\t{\n";
+            for(std::string_view k : c.keysetBindings)
+            {
+                if(c.keyColumns.size() == 1)
+                {
+                    this->out << "\t\t\t\t$stmt->bindValue($i++, $lastId);\n";
+                }
+                else
+                {
+                    this->out << "\t\t\t\t$stmt->bindValue($i++, $lastKey['" << k << "']);\n";
+                }
+            }
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\t$stmt->bindValue($i, (int)$limit, PDO::PARAM_INT);\n";
+            this->out << "\n";
+            this->out << "\t\t\t// execute query\n";
+            this->out << "\t\t\t$stmt->execute();\n";
+            this->out << "\n";
+            this->out << "\t\t\t// return values from database\n";
+            this->out << "\t\t\treturn $stmt;\n";
+            this->out << "\t\t}\n";
+            this->out << "\n";
+        }
+
+        /**
+        * Function that writes a findBy method for each
+        * index of the table
+        * Each method selects the records whose indexed
+        * columns equal its parameters, with the conditions
+        * in the order of the index so the database can use
+        * it. Methods of unique indexes return one object
+        * or null, the others an array of objects.
+        * @return void
+        */
+        void createFindBy()
+        {
+            const ModelContext &c = this->context;
+            for(const ModelFinder &f : c.finders)
+            {
+                this->out << f.comment.view();
+                this->out << "\t\tpublic function " << f.name << "(" << f.parameters << ")"
+                          << (f.unique ? " : ?static" : " : array") << "\n";
+                this->out << "\t\t{\n";
+                this->out << "\t\t\t//query the index answers\n";
+                this->out << "\t\t\t$query = \"SELECT " << c.selectList << "\n";
+                this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n";
+                this->out << "\t\t\t\t WHERE " << f.whereClause;
+                if(!c.liveCondition.empty())
+                {
+                    this->out << " AND " << c.liveCondition;
+                }
+                this->out << "\";\n";
+                this->out << "\n";
+                this->out << "\t\t\t//prepare query\n";
+                this->prepareQuery("\"" + f.name + "\"", "\t\t\t$stmt = $this->conn->prepare($query);\n");
+                this->out << "\n";
+                this->out << "\t\t\t//execute query\n";
+                this->out << "\t\t\t$stmt->execute([" << f.parameters << "]);\n";
+                if(f.unique)
+                {
+                    this->out << "\t\t\t$row = $stmt->fetch(PDO::FETCH_ASSOC);\n";
+                    this->out << "\t\t\t$stmt->closeCursor();\n";
+                    this->out << "\t\t\treturn $row === false ? null : $this->fromRow($row);\n";
+                }
+                else
+                {
+                    this->out << "\t\t\treturn $this->hydrateAll($stmt);\n";
+                }
+                this->out << "\t\t}\n";
+                this->out << "\n";
+            }
+        }
+
+        /**
+        * Function that writes an iterate function that
+        * yields every record of the class's table
+        * Writes comments and a generator function that reads
+        * the table in keyset pages with readAfter, or in one
+        * unbuffered query on MySQL when asked to, and yields
+        * each row as an object filled by hydrate.
+        * @return void
+        */
+        void createIterate()
+        {
+            const ModelContext &c = this->context;
+            this->out << c.comments[PHPTemplateSet::Iterate].view();
+            this->out << "\t\tpublic function iterate(int $batch = 1000, bool $reuse = false, bool $unbuffered = false)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t$batch = max(1, $batch);\n";
+            this->out << "\t\t\t$object = $reuse ? new static($this->conn) : null;\n";
+            this->out << "\t\t\tif($unbuffered && $this->conn->getAttribute(PDO::ATTR_DRIVER_NAME) == \"mysql\")\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t//rows are fetched from the server as they are read\n";
+            this->out << "\t\t\t\t$buffered = $this->conn->getAttribute(PDO::MYSQL_ATTR_USE_BUFFERED_QUERY);\n";
+            this->out << "\t\t\t\t$this->conn->setAttribute(PDO::MYSQL_ATTR_USE_BUFFERED_QUERY, false);\n";
+            this->out << "\t\t\t\t$stmt = null;\n";
+            this->out << "\t\t\t\ttry\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$stmt = $this->read();\n";
+            this->out << "\t\t\t\t\twhile(($row = $stmt->fetch(PDO::FETCH_ASSOC)) !== false)\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\tyield $this->hydrate($row, $object);\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\tfinally\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t//the rest of the result must be discarded before the connection is used again\n";
+            this->out << "\t\t\t\t\tif($stmt)\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t$stmt->closeCursor();\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t$this->conn->setAttribute(PDO::MYSQL_ATTR_USE_BUFFERED_QUERY, $buffered);\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\treturn;\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\n";
+            this->out << "\t\t\t//keyset pages keep at most $batch rows in memory\n";
+            this->out << "\t\t\t$last = null;\n";
+            this->out << "\t\t\tdo\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$stmt = $this->readAfter($last, $batch);\n";
+            this->out << "\t\t\t\t$count = 0;\n";
+            this->out << "\t\t\t\twhile(($row = $stmt->fetch(PDO::FETCH_ASSOC)) !== false)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$count++;\n";
+            if(c.keyColumns.size() == 1)
             {
-                this->out << "\t\t\t$this->" << f << "=htmlspecialchars(strip_tags($" << f << "));\n";
+                this->out << "\t\t\t\t\t$last = $row['ID'];\n";
+            }
+            else
+            {
+                this->out << "\t\t\t\t\t$last = $row;\n";
             }
+            this->out << "\t\t\t\t\tyield $this->hydrate($row, $object);\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\t$stmt->closeCursor();\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\twhile($count == $batch);\n";
+            this->out << "\t\t}\n";
+            this->out << "\n";
         }
 
         /**
-        * Function that writes a read function to 
-        * retrieve all records
-        * Writes comments and function to read all 
-        * records from the class's table
+        * Function that writes the functions that turn rows
+        * into objects
+        * Writes comments and the fromRow and hydrateAll
+        * functions, followed by the hydrate function they
+        * and iterate share. Every field is copied by a line
+        * of its own, converted to its declared type, so no
+        * method is called per row in hydrateAll.
         * @return void
         */
-        void createRead()
+        void createHydrate()
         {
-            std::string Description = "Retrieves all records from " 
-                                    + this->stringToLower(this->className) 
-                                    + "s view.";
-            std::vector<std::pair<std::string, std::string>> Params = {};
-            std::string DetailedDescription = "Prepares and executes a simple Select statement to"
-                                            " retrieve all records in the " 
-                                            + this->stringToLower(this->className) 
-                                            + " view.";
-            std::string returnType = "PDOStatement";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
-            this->out << "\t\t//Selects all records\n";
-            this->out << "\t\tpublic function read()\n";
+            const ModelContext &c = this->context;
+            this->out << c.comments[PHPTemplateSet::Hydrate].view();
+            this->out << "\t\tpublic function fromRow(array $row): static\n";
             this->out << "\t\t{\n";
-            this->out << "\t\t\t$query = \"SELECT * \n";
-            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n"; 
-            this->out << "\t\t\t\t ORDER BY ID ASC\";\n"; 
-            this->out << "\n";
-            this->out << "\t\t\t//prepare query\n";
-            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
-            this->out << "\n";
-            this->out << "\t\t\t//execute\n";
-            this->out << "\t\t\t$stmt->execute();\n";
+            this->out << "\t\t\treturn $this->hydrate($row, null);\n";
+            this->out << "\t\t}\n";
             this->out << "\n";
-            this->out << "\t\t\treturn $stmt;\n";
-            this->out << "\t\t}";
+            this->out << c.hydrateAllComment.view();
+            this->out << "\t\tpublic function hydrateAll(PDOStatement $s): array\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t//cloning skips the constructor for every row\n";
+            this->out << "\t\t\t$prototype = new static($this->conn);\n";
+            this->out << "\t\t\t$objects = [];\n";
+            this->out << "\t\t\twhile(($row = $s->fetch(PDO::FETCH_ASSOC)) !== false)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$object = clone $prototype;\n";
+            this->setObjectPropertiesFromQuery("$object", "\t\t\t\t");
+            this->out << "\t\t\t\t$objects[] = $object;\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\treturn $objects;\n";
+            this->out << "\t\t}\n";
             this->out << "\n";
+            this->out << "\t/**\n";
+            this->out << "\t * Copies a row into an object, creating one when none is given.\n";
+            this->out << "\t *\n";
+            this->out << "\t * @param array $row row fetched with PDO::FETCH_ASSOC\n";
+            this->out << "\t * @param " << this->className << " $object object to fill, null for a new one\n";
+            this->out << "\t * @return " << this->className << "\n";
+            this->out << "\t*/\n";
+            this->out << "\t\tprivate function hydrate(array $row, $object)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\tif($object === null)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$object = new static($this->conn);\n";
+            this->out << "\t\t\t}\n";
+            this->setObjectPropertiesFromQuery("$object", "\t\t\t");
+            this->out << "\t\t\treturn $object;\n";
+            this->out << "\t\t}\n";
             this->out << "\n";
         }
 
         /**
-        * Function that writes a read one function to 
-        * retrieve a record by an ID
-        * Writes comments and function to read one 
-        * record from the class's table with the
-        * class's id. 
+        * Function that writes a count function to 
+        * retrieve the total number of records in the
+        * class's table
+        * Writes comments and function to retrieves the
+        * total number of records from the class's
+        * table  
         * @return void
         */
-        void createReadOne()
+        void createCount()
         {
-            std::string Description = "Retrieves one " 
-                                    + this->stringToLower(this->className) 
-                                    + " record by ID";
-            std::vector<std::pair<std::string, std::string>> Params = {};
-            std::string DetailedDescription = "Prepares and executes a simple Select statement "
-                                              "retrieving all values for one record and updates the "
-                                            +  this->stringToLower(this->className) + " object.";
-            std::string returnType = "void";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
-            this->out << "\t\tpublic function readOne() : void\n";
+            this->out << this->context.comments[PHPTemplateSet::Count].view();
+            this->out << "\t\t//Retrieves total number of rows in table\n";
+            this->out << "\t\tpublic function count(): int\n";
             this->out << "\t\t{\n";
-            this->out << "\t\t\t//query to read single record\n";
-            this->out << "\t\t\t$query = \"SELECT * \n";
-            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n"; 
-            this->out << "\t\t\t\t WHERE Id = ?\n"; 
-            this->out << "\t\t\t\t WHERE LIMIT 0,1\";\n"; 
-            this->out << "\n";
-            this->out << "\t\t\t//prepare query\n";
-            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
-            this->out << "\n";
-            this->out << "\t\t\t//bind id of product to be updated\n";
-            this->out << "\t\t\t$stmt->bindParam(1, $this->Id);\n"; 
-            this->out << "\n";
-            this->out << "\t\t\t//execute query\n";
+            this->out << "\t\t\t$query = \"SELECT COUNT(*) as count FROM \" . $this->table_name . \"";
+            if(!this->context.liveCondition.empty())
+            {
+                this->out << " WHERE " << this->context.liveCondition;
+            }
+            this->out << "\";\n";
+            this->prepareQuery("\"count\"", "\t\t\t$stmt = $this->conn->prepare($query);\n");
             this->out << "\t\t\t$stmt->execute();\n";
-            this->out << "\n";
-            this->out << "\t\t\t//get retrieved row\n";
             this->out << "\t\t\t$row = $stmt->fetch(PDO::FETCH_ASSOC);\n";
-            this->out << "\n";
-            this->setObjectPropertiesFromQuery();
-            this->out << "\t\t}";
-            this->out << "\n";
+            this->out << "\t\t\treturn $row['count'];\n";
+            this->out << "\t\t}\n";
             this->out << "\n";
         }
 
         /**
-        * Function that writes a read paging function to 
-        * retrieve records in certain amounts
-        * Writes comments and function to read specific
-        * amounts of retrieved records from the class's
-        * table  
+        * Function that writes a count function that reads
+        * the row count estimate of the database
+        * Writes comments and a countApprox function that
+        * asks the table statistics of SQLite, MySQL or
+        * PostgreSQL for the number of rows and falls back
+        * to count on other drivers or missing statistics.
         * @return void
         */
-        void createReadPaging()
+        void createCountApprox()
         {
-            std::string Description = "Retrieves a certain number of records from " 
-                                    + this->stringToLower(this->className) 
-                                    + " view.";
-            std::vector<std::pair<std::string, std::string>> Params = { 
-                std::make_pair("int", "$from_record_num first record to display"),
-                std::make_pair("int", "$records_per_page total number of records to retrieve")
-                };
-            std::string DetailedDescription = "Prepares and executes a simple Select statement"
-                                            " to retrieve records starting from an id to a "
-                                            "certain id in the " 
-                                            + this->stringToLower(this->className) + " view.";
-            std::string returnType = "PDOStatement";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
-            this->out << "\t\tpublic function readPaging($from_record_num, $records_per_page)\n";
+            this->out << this->context.comments[PHPTemplateSet::CountApprox].view();
+            this->out << "\t\tpublic function countApprox(): int\n";
             this->out << "\t\t{\n";
-            this->out << "\t\t\t// select query\n";
-            this->out << "\t\t\t$query = \"SELECT * \n";
-            this->out << "\t\t\t\tFROM \" . $this->table_name . \"\n";
-            this->out << "\t\t\t\tORDER BY ID ASC\n";
-            this->out << "\t\t\t\tLIMIT ?, ?\";";
-            this->out << "\n";
-            this->out << "\t\t\t// prepare query statement\n";
-            this->out << "\t\t\t$stmt = $this->conn->prepare( $query );\n;";
-            this->out << "\n";
-            this->out << "\t\t\t// bind variable values\n";
-            this->out << "\t\t\t$stmt->bindParam(1, $from_record_num, PDO::PARAM_INT);\n";
-            this->out << "\t\t\t$stmt->bindParam(2, $records_per_page, PDO::PARAM_INT);\n";
+            this->out << "\t\t\t$driver = $this->conn->getAttribute(PDO::ATTR_DRIVER_NAME);\n";
+            this->out << "\t\t\tif($driver == \"sqlite\")\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t//the first number of stat is the row count ANALYZE saw\n";
+            this->out << "\t\t\t\t$query = \"SELECT stat FROM sqlite_stat1 WHERE tbl = ? LIMIT 1\";\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\telse if($driver == \"mysql\")\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$query = \"SELECT TABLE_ROWS FROM information_schema.TABLES\n";
+            this->out << "\t\t\t\t\tWHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ?\";\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\telse if($driver == \"pgsql\")\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$query = \"SELECT reltuples FROM pg_class WHERE oid = to_regclass(?)\";\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\telse\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\treturn $this->count();\n";
+            this->out << "\t\t\t}\n";
             this->out << "\n";
-            this->out << "\t\t\t// execute query\n";
-            this->out << "\t\t\t$stmt->execute();\n";
+            this->out << "\t\t\t$estimate = false;\n";
+            this->out << "\t\t\ttry\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$stmt = $this->conn->prepare($query);\n";
+            this->out << "\t\t\t\tif($stmt !== false && $stmt->execute([$this->table_name]))\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$estimate = $stmt->fetchColumn();\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\tcatch(PDOException $e)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t//sqlite_stat1 only exists once ANALYZE has run\n";
+            this->out << "\t\t\t\t$estimate = false;\n";
+            this->out << "\t\t\t}\n";
             this->out << "\n";
-            this->out << "\t\t\t// return values from database\n";
-            this->out << "\t\t\treturn $stmt;\n";
+            this->out << "\t\t\t//PostgreSQL reports -1 for tables it has not analyzed yet\n";
+            this->out << "\t\t\tif($estimate === false || $estimate === null || (int)$estimate < 0)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\treturn $this->count();\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\treturn (int)$estimate;\n";
             this->out << "\t\t}\n";
             this->out << "\n";
         }
 
         /**
-        * Function that writes a count function to 
-        * retrieve the total number of records in the
-        * class's table
-        * Writes comments and function to retrieves the
-        * total number of records from the class's
-        * table  
+        * Function that writes a count function that keeps
+        * counts for a number of seconds
+        * Writes comments and a countCached function that
+        * returns the count or estimate stored in the static
+        * $counts array of the class while it is younger than
+        * the given ttl, and refreshes it otherwise.
         * @return void
         */
-        void createCount()
+        void createCountCached()
         {
-            std::string Description = "Retrieves the total number of records in " 
-                                    + this->stringToLower(this->className) 
-                                    + " view.";
-            std::vector<std::pair<std::string, std::string>> Params = {};
-            std::string DetailedDescription = "Prepares and executes a simple Select statement "
-                                            "retreiving the count for all rows in the " 
-                                            + this->stringToLower(this->className) 
-                                            + " view.";
-            std::string returnType = "int";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
-            this->out << "\t\t//Retrieves total number of rows in table\n";
-            this->out << "\t\tpublic function count(): int\n";
+            this->out << this->context.comments[PHPTemplateSet::CountCached].view();
+            this->out << "\t\tpublic function countCached(int $ttl = 60, bool $approximate = false): int\n";
             this->out << "\t\t{\n";
-            this->out << "\t\t\t$query = \"SELECT COUNT(*) as count FROM \" . $this->table_name . \"\";\n";
-            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
-            this->out << "\t\t\t$stmt->execute();\n";
-            this->out << "\t\t\t$row = $stmt->fetch(PDO::FETCH_ASSOC);\n";
-            this->out << "\t\t\treturn $row['count'];\n";
+            this->createConnectionKey("($approximate ? \":approx\" : \":exact\")");
+            this->out << "\t\t\t$now = microtime(true);\n";
+            this->out << "\t\t\tif(isset(self::$counts[$key]) && $now - self::$counts[$key][\"time\"] < $ttl)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\treturn self::$counts[$key][\"count\"];\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\t$count = $approximate ? $this->countApprox() : $this->count();\n";
+            this->out << "\t\t\tself::$counts[$key] = [\"count\" => $count, \"time\" => $now, \"conn\" => $this->conn];\n";
+            this->out << "\t\t\treturn $count;\n";
             this->out << "\t\t}\n";
             this->out << "\n";
         }
@@ -520,51 +1723,16 @@ class PHPBuilder
         */
         void createInsert()
         {
-            std::string Description = "Inserts a record into the " 
-                                    + this->stringToLower(this->className) 
-                                    + " table.";
-            std::vector<std::pair<std::string, std::string>> Params = {};
-            std::string DetailedDescription = "Inserts a record into the " 
-                                            + this->stringToLower(this->className) 
-                                            + " table using currently set properties in " 
-                                            + this->stringToLower(this->className) 
-                                            + " object. If successful returns true.";
-            std::string returnType = "bool";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
+            this->out << this->context.comments[PHPTemplateSet::Insert].view();
             this->out << "\t\tpublic function Insert(): bool \n";
             this->out << "\t\t{\n";
             this->out << "\t\t\t$query = \"INSERT INTO \n"; 
             this->out << "\t\t\t\" . $this->table_name . \"\n"; 
             this->out << "\t\t\tSET \n"; 
-            int i = 1; 
-            for(std::string f : this->Fields)
-            {
-                if(i % 2 != 0)
-                {
-                    this->out << "\t\t\t\t";
-                }
-                this->out << f << "=:" << f;
-                if(i < this->Fields.size())
-                {
-                    if(i %2 == 0)
-                    {
-                        this->out << ",\n"; 
-                    }
-                    else
-                    {
-                        this->out << ", ";
-                    }
-                }
-                else
-                {
-                    this->out << "\";\n";
-                }
-                
-                i++;
-            }
+            this->out << this->context.setClause;
             this->out << "\n";
             this->out << "\t\t\t//prepare query\n";
-            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
+            this->prepareQuery("\"insert\"", "\t\t\t$stmt = $this->conn->prepare($query);\n");
             this->out << "\n";
             this->sanitizeFields();
             this->out << "\n";
@@ -580,60 +1748,238 @@ class PHPBuilder
             this->out << "\n";
         }
 
+        /**
+        * Function that writes a bulk insert function to
+        * insert many records into the class's table
+        * Writes comments and a static function that inserts
+        * an array of objects with multi-row VALUES statements,
+        * one transaction per chunk of rows, and returns the
+        * inserted IDs. Objects that already have an ID are
+        * inserted with it in a statement of their own; the
+        * others leave ID out so the database numbers them,
+        * and only they are given the IDs it returns. As
+        * MySQL may not number the rows of one statement
+        * consecutively, other drivers than PostgreSQL and
+        * SQLite insert new objects one row at a time. Rows per
+        * statement are limited so a statement never has more
+        * than 999 placeholders, the lowest default limit of
+        * the supported databases.
+        * @return void
+        */
+        void createInsertMany()
+        {
+            const ModelContext &c = this->context;
+            size_t maxRows = std::max<size_t>(1, 999 / std::max<size_t>(1, this->Fields.size()));
+            this->out << "\n";
+            this->out << c.comments[PHPTemplateSet::InsertMany].view();
+            this->out << "\t\tpublic static function insertMany(PDO $db, array $objects, int $chunk = 500)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t// " << std::to_string(this->Fields.size()) << " placeholders per row, at most 999 per statement\n";
+            this->out << "\t\t\t$rowsPerStatement = max(1, min($chunk, " << std::to_string(maxRows) << "));\n";
+            this->out << "\t\t\t$driver = $db->getAttribute(PDO::ATTR_DRIVER_NAME);\n";
+            this->out << "\t\t\t$ids = [];\n";
+            this->out << "\t\t\tforeach(array_chunk($objects, $rowsPerStatement) as $rows)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t//objects given an ID keep it, the others are numbered by the database\n";
+            this->out << "\t\t\t\t$groups = [\"given\" => [], \"new\" => []];\n";
+            this->out << "\t\t\t\tforeach($rows as $object)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$groups[$object->ID === null ? \"new\" : \"given\"][] = $object;\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\n";
+            this->out << "\t\t\t\t//one transaction per chunk unless the caller opened one\n";
+            this->out << "\t\t\t\t$transaction = !$db->inTransaction();\n";
+            this->out << "\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$db->beginTransaction();\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\ttry\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\tforeach($groups as $group => $members)\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\tif(count($members) == 0)\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\tcontinue;\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\tif($group == \"new\" && $driver != \"pgsql\" && $driver != \"sqlite\")\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t//MySQL does not promise consecutive IDs within one statement, so each row is inserted on its own\n";
+            this->out << "\t\t\t\t\t\t\t$stmt = $db->prepare(\"INSERT INTO " << this->tableName << "\n";
+            this->out << "\t\t\t\t\t\t\t\t(" << c.newColumnList << ")\n";
+            this->out << "\t\t\t\t\t\t\t\tVALUES " << c.newRowPlaceholders << "\");\n";
+            this->out << "\t\t\t\t\t\t\t$inserted = [];\n";
+            this->out << "\t\t\t\t\t\t\tforeach($members as $object)\n";
+            this->out << "\t\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t\t$values = [];\n";
+            for(std::string_view f : this->Fields)
+            {
+                if(f != "ID")
+                {
+                    this->out << "\t\t\t\t\t\t\t\t$values[] = $object->" << f << ";\n";
+                }
+            }
+            this->out << "\t\t\t\t\t\t\t\tif($stmt === false || !$stmt->execute($values))\n";
+            this->out << "\t\t\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t\t\t\t$db->rollBack();\n";
+            this->out << "\t\t\t\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t\t\t\treturn false;\n";
+            this->out << "\t\t\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t\t\t$inserted[] = (int)$db->lastInsertId();\n";
+            this->out << "\t\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t\t//IDs are only set once every row is in\n";
+            this->out << "\t\t\t\t\t\t\tforeach($members as $n => $object)\n";
+            this->out << "\t\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t\t$object->ID = $inserted[$n];\n";
+            this->out << "\t\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t\tcontinue;\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\tif($group == \"given\")\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t$query = \"INSERT INTO " << this->tableName << "\n";
+            this->out << "\t\t\t\t\t\t\t\t(" << c.columnList << ")\n";
+            this->out << "\t\t\t\t\t\t\t\tVALUES \" . implode(\", \", array_fill(0, count($members), \"" << c.rowPlaceholders << "\"));\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\telse\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t$query = \"INSERT INTO " << this->tableName << "\n";
+            this->out << "\t\t\t\t\t\t\t\t(" << c.newColumnList << ")\n";
+            this->out << "\t\t\t\t\t\t\t\tVALUES \" . implode(\", \", array_fill(0, count($members), \"" << c.newRowPlaceholders << "\"));\n";
+            this->out << "\t\t\t\t\t\t\tif($driver == \"pgsql\")\n";
+            this->out << "\t\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t\t$query .= \" RETURNING ID\";\n";
+            this->out << "\t\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t$values = [];\n";
+            this->out << "\t\t\t\t\t\tforeach($members as $object)\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            for(std::string_view f : this->Fields)
+            {
+                if(f == "ID")
+                {
+                    this->out << "\t\t\t\t\t\t\tif($group == \"given\")\n";
+                    this->out << "\t\t\t\t\t\t\t{\n";
+                    this->out << "\t\t\t\t\t\t\t\t$values[] = $object->ID;\n";
+                    this->out << "\t\t\t\t\t\t\t}\n";
+                    continue;
+                }
+                this->out << "\t\t\t\t\t\t\t$values[] = $object->" << f << ";\n";
+            }
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t$stmt = $db->prepare($query);\n";
+            this->out << "\t\t\t\t\t\tif($stmt === false || !$stmt->execute($values))\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t\t$db->rollBack();\n";
+            this->out << "\t\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\t\treturn false;\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\tif($group == \"given\")\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\tcontinue;\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\n";
+            this->out << "\t\t\t\t\t\t//IDs of the inserted rows, all of them new\n";
+            this->out << "\t\t\t\t\t\tif($driver == \"pgsql\")\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t$inserted = $stmt->fetchAll(PDO::FETCH_COLUMN, 0);\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\telse\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t//SQLite has one writer, so the rowids of a statement are consecutive and end at the last one\n";
+            this->out << "\t\t\t\t\t\t\t$last = (int)$db->lastInsertId();\n";
+            this->out << "\t\t\t\t\t\t\t$inserted = range($last - count($members) + 1, $last);\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\tforeach($members as $n => $object)\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t$object->ID = (int)$inserted[$n];\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t$db->commit();\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\tcatch(PDOException $e)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t$db->rollBack();\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\tthrow $e;\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\tforeach($rows as $object)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$ids[] = $object->ID;\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\treturn $ids;\n";
+            this->out << "\t\t}\n";
+        }
+
         /**
         * Function that writes an update function to 
         * update a record in the class's table
         * Writes comments and function to update the
         * a record at a certain ID into the class's
-        * table using the properties set in the class. 
+        * table using the properties set in the class.
+        * Only the columns whose values differ from the
+        * snapshot taken when the record was read are set,
+        * as bound parameters, so the query text only
+        * depends on which columns changed. Scalars are
+        * compared as strings, as untyped columns are read
+        * as the strings the driver returns.
         * @return void
         */
         void createUpdate()
         {
-            std::string Description = "Updates a record in sources " 
-                                    + this->stringToLower(this->className) 
-                                    + " table using currently  set properties in " 
-                                    + this->stringToLower(this->className) 
-                                    + " object.";
-            std::vector<std::pair<std::string, std::string>> Params = {
-                std::make_pair("int",  "ID Integer for ID to update")};
-            std::string DetailedDescription = "Updates a record in the " 
-                                            + this->stringToLower(this->className) 
-                                            + " table using currently set properties in " 
-                                            + this->stringToLower(this->className) 
-                                            + " object for a given id. If successful returns true.";
-            std::string returnType = "bool";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
+            this->out << this->context.comments[PHPTemplateSet::Update].view();
             this->out << "\t\tpublic function update($ID): bool \n";
             this->out << "\t\t{\n";
+            this->out << "\t\t\t//a snapshot of another record says nothing about this one\n";
+            this->out << "\t\t\tif(!isset($this->snapshot['ID']) || $this->snapshot['ID'] != $ID)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$this->snapshot = [];\n";
+            this->out << "\t\t\t}\n";
             this->out << "\t\t\t$this->ID = $ID;\n";
-            this->out << "\t\t\t$properties = get_object_vars($this);\n";
-            this->out << "\t\t\t$keys = array_keys($properties);\n";
-            this->out << "\t\t\t$propertiesToExclude = [\"ID\", \"conn\", \"table_name\"];\n";
-            this->out << "\t\t\t$first = true;\n";
-            this->out << "\t\t\t$query = \"UPDATE \" . $this->table_name . \"\n";
-            this->out << "\t\t\t\tSET\";\n";
-            this->out << "\t\t\tforeach($keys as $k)\n";
+            this->out << "\t\t\t$changed = [];\n";
+            this->out << "\t\t\tforeach(self::COLUMNS as $column)\n";
             this->out << "\t\t\t{\n";
-            this->out << "\t\t\t\tif(in_array($k, $propertiesToExclude) == false)\n";
+            this->out << "\t\t\t\t//untyped columns are read as strings, so 5 and \"5\" are the same value\n";
+            this->out << "\t\t\t\tif($column != \"ID\" && (!array_key_exists($column, $this->snapshot)\n";
+            this->out << "\t\t\t\t\t|| !($this->snapshot[$column] === $this->$column\n";
+            this->out << "\t\t\t\t\t\t|| (is_scalar($this->snapshot[$column]) && is_scalar($this->$column)\n";
+            this->out << "\t\t\t\t\t\t\t&& (string)$this->snapshot[$column] === (string)$this->$column))))\n";
             this->out << "\t\t\t\t{\n";
-            this->out << "\t\t\t\t\tif($first == true)\n";
-            this->out << "\t\t\t\t\t{\n";
-            this->out << "\t\t\t\t\t\t$query .= \" \" . $k . \"='\" . $properties[$k] . \"'\";\n";
-            this->out << "\t\t\t\t\t\t$first=false;\n";
-            this->out << "\t\t\t\t\t}\n";
-            this->out << "\t\t\t\t\telse\n";
-            this->out << "\t\t\t\t\t{\n";
-            this->out << "\t\t\t\t\t\t$query .= \", \" . $k . \"='\" . $properties[$k] . \"'\";\n";
-            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t$changed[] = $column;\n";
             this->out << "\t\t\t\t}\n";
-            this->out << "\t\t\t};\n";
-            this->out << "\t\t\t$query .= \" WHERE ID = '\" . $ID . \"'\";\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\t//nothing to write\n";
+            this->out << "\t\t\tif(count($changed) == 0)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\treturn true;\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\t$query = \"UPDATE \" . $this->table_name . \"\n";
+            this->out << "\t\t\t\tSET \" . implode(\" = ?, \", $changed) . \" = ?\n";
+            this->out << "\t\t\t\tWHERE ID = ?\";\n";
             this->out << "\t\t\t//Prepare query\n";
-            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
+            this->prepareQuery("\"update \" . implode(\",\", $changed)", "\t\t\t$stmt = $this->conn->prepare($query);\n");
+            this->out << "\t\t\t$i = 1;\n";
+            this->out << "\t\t\tforeach($changed as $column)\n";
+            this->out << "\t\t\t{\n";
+            this->out << "\t\t\t\t$stmt->bindValue($i++, $this->$column);\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\t$stmt->bindValue($i, $ID);\n";
             this->out << "\t\t\t//Execute Query\n";
             this->out << "\t\t\tif($stmt->execute())\n";
             this->out << "\t\t\t{\n"; 
+            this->out << "\t\t\t\tforeach($changed as $column)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$this->snapshot[$column] = $this->$column;\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\t$this->snapshot['ID'] = $ID;\n";
             this->out << "\t\t\t\treturn true;\n";
             this->out << "\t\t\t}\n"; 
             this->out << "\t\t\telse\n"; 
@@ -648,29 +1994,31 @@ class PHPBuilder
         * remove a record in the class's table.
         * Writes comments and function to remove the
         * a record at a certain ID in the class's table.
+        * With soft_delete the record is marked instead.
         * @return void
         */
         void createRemove()
         {
-            std::string Description = "Removes a record in " + this->stringToLower(this->className) 
-                                    + " by ID";
-            std::vector<std::pair<std::string, std::string>> Params = {};
-            std::string DetailedDescription = "Prepares and executes a query to delete a record in the " 
-                                            + this->stringToLower(this->className) 
-                                            + "table. If successful, returns true.";
-            std::string returnType = "bool";
-            this->createMethodComment(Description, DetailedDescription, Params, returnType);
+            this->out << this->context.comments[PHPTemplateSet::Remove].view();
             this->out << "\t\tpublic function remove(): bool \n";
             this->out << "\t\t{\n";
-            this->out << "\t\t\t$query = \"DELETE * FROM\n";
-            this->out << "\t\t\t\t\" . $this->table_name . \"\n";
-            this->out << "\t\t\t\tWHERE Id = ?\";\n";
+            if(this->softDelete.empty())
+            {
+                this->out << "\t\t\t$query = \"DELETE FROM\n";
+                this->out << "\t\t\t\t\" . $this->table_name . \"\n";
+                this->out << "\t\t\t\tWHERE ID = ?\";\n";
+            }
+            else
+            {
+                this->out << "\t\t\t$query = \"UPDATE \" . $this->table_name . \"\n";
+                this->out << "\t\t\t\tSET " << this->softDelete << " = CURRENT_TIMESTAMP\n";
+                this->out << "\t\t\t\tWHERE ID = ? AND " << this->context.liveCondition << "\";\n";
+            }
             this->out << "\t\t\t//Prepare query\n";
-            this->out << "\t\t\t$stmt = $this->conn->prepare($query);\n";
-            this->out << "\t\t\t$this->id=htmlspecialchars(strip_tags($this->id));\n";
+            this->prepareQuery("\"remove\"", "\t\t\t$stmt = $this->conn->prepare($query);\n");
             this->out << "\n";
-            this->out << "\t\t\t//bind id of reocord to delete\n";
-            this->out << "\t\t\t$stmt->bindParam(1, $this->id);\n";
+            this->out << "\t\t\t//bind id of record to delete\n";
+            this->out << "\t\t\t$stmt->bindValue(1, $this->ID);\n";
             this->out << "\t\t\t//Execute Query\n";
             this->out << "\t\t\tif($stmt->execute())\n";
             this->out << "\t\t\t{\n"; 
@@ -683,16 +2031,100 @@ class PHPBuilder
             this->out << "\t\t}\n";
         }
 
+        /**
+        * Function that writes a static removeMany function
+        * that removes records by ID in batches
+        * Writes comments and function to delete, or with
+        * soft_delete mark, the records with the given IDs
+        * using chunked ID IN (...) statements, each in a
+        * transaction of its own unless the caller has
+        * opened one.
+        * @return void
+        */
+        void createRemoveMany()
+        {
+            this->out << "\n";
+            this->out << this->context.comments[PHPTemplateSet::RemoveMany].view();
+            this->out << "\t\tpublic static function removeMany(PDO $db, array $ids, int $chunk = 500)\n";
+            this->out << "\t\t{\n";
+            this->out << "\t\t\t$idsPerStatement = max(1, min($chunk, 999));\n";
+            this->out << "\t\t\t$removed = 0;\n";
+            this->out << "\t\t\tforeach(array_chunk(array_values($ids), $idsPerStatement) as $rows)\n";
+            this->out << "\t\t\t{\n";
+            if(this->softDelete.empty())
+            {
+                this->out << "\t\t\t\t$query = \"DELETE FROM " << this->tableName << "\n";
+                this->out << "\t\t\t\t\tWHERE ID IN (\" . implode(\", \", array_fill(0, count($rows), \"?\")) . \")\";\n";
+            }
+            else
+            {
+                this->out << "\t\t\t\t$query = \"UPDATE " << this->tableName << "\n";
+                this->out << "\t\t\t\t\tSET " << this->softDelete << " = CURRENT_TIMESTAMP\n";
+                this->out << "\t\t\t\t\tWHERE " << this->context.liveCondition
+                          << " AND ID IN (\" . implode(\", \", array_fill(0, count($rows), \"?\")) . \")\";\n";
+            }
+            this->out << "\n";
+            this->out << "\t\t\t\t//one transaction per statement unless the caller opened one\n";
+            this->out << "\t\t\t\t$transaction = !$db->inTransaction();\n";
+            this->out << "\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$db->beginTransaction();\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\ttry\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t$stmt = $db->prepare($query);\n";
+            this->out << "\t\t\t\t\tif($stmt === false || !$stmt->execute($rows))\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t\t$db->rollBack();\n";
+            this->out << "\t\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t\treturn false;\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\t$removed += $stmt->rowCount();\n";
+            this->out << "\t\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t$db->commit();\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t\tcatch(PDOException $e)\n";
+            this->out << "\t\t\t\t{\n";
+            this->out << "\t\t\t\t\tif($transaction)\n";
+            this->out << "\t\t\t\t\t{\n";
+            this->out << "\t\t\t\t\t\t$db->rollBack();\n";
+            this->out << "\t\t\t\t\t}\n";
+            this->out << "\t\t\t\t\tthrow $e;\n";
+            this->out << "\t\t\t\t}\n";
+            this->out << "\t\t\t}\n";
+            this->out << "\t\t\treturn $removed;\n";
+            this->out << "\t\t}\n";
+        }
+
+        /**
+        * Writes the condition that leaves out soft deleted
+        * rows as a WHERE line of a query. Writes nothing
+        * without soft_delete.
+        * @return void
+        */
+        void writeLiveWhere()
+        {
+            if(!this->context.liveCondition.empty())
+            {
+                this->out << "\t\t\t\t WHERE " << this->context.liveCondition << "\n";
+            }
+        }
+
         /**
          * Function that converts a string to lower case
          * Taken from //http://cplusplus.com/forum/beginner/218745/
          * Loops through characters in string and converts each 
          * character to lower. 
-         * @param str string 
+         * @param text string_view 
          * @return string
          */
-        std::string stringToLower(std::string str)
+        std::string stringToLower(std::string_view text)
         {
+            std::string str(text);
             for (size_t i=0; i<str.size(); ++i) 
             {
                 if (isalpha(str[i])) 
@@ -718,36 +2150,73 @@ class PHPBuilder
         * with the built in CRUD methods
         * Function creates a php class file
         * with the class name, properties, constructor,
-        * read, readOne, readPaging, count, 
-        * checkIfExists, getIfExists, insert,
-        * update, and remove functions. 
-        * @return void
-        */
-        void createClassFile()
-        {
-            std::cout << "Creating opening.\n"; 
-            this->opening();
-            std::cout << "Creating Constructor.\n"; 
-            this->createConstructor();
-            std::cout << "Creating Read Method.\n"; 
-            this->createRead();
-            std::cout << "Creating ReadOne Method.\n"; 
-            this->createReadOne();
-            std::cout << "Creating ReadPaging Method.\n"; 
-            this->createReadPaging();
-            std::cout << "Creating Count Method.\n"; 
-            this->createCount();
-            std::cout << "Creating CheckIfExists Method.\n"; 
-            this->createCheckIfExists();
-            std::cout << "Creating Insert Method.\n"; 
-            this->createInsert();
-            std::cout << "Creating Update Method.\n"; 
-            this->createUpdate();
-            std::cout << "Creating Remove Method.\n"; 
-            this->createRemove();
-            std::cout << "Creating Closing Method.\n"; 
-            this->closing();
-            this->out.close();
+        * read, readOne, readColumns, readPaging, readAfter, iterate, count, 
+        * checkIfExists, insert, insertMany,
+        * update, and remove functions. Any of these
+        * parts with a loaded template is rendered from
+        * the template instead. The class is
+        * rendered into a buffer by renderClass and written to the
+        * output file in one piece once it is complete.
+        * An existing file with identical contents is not
+        * rewritten so its modification time is kept.
+        * Returns false if the output file could not be 
+        * written, leaving any existing file untouched.
+        * @return bool
+        */
+        bool createClassFile()
+        {
+            this->renderClass();
+            int64_t start = this->trace != nullptr ? this->trace->now() : 0;
+            bool written = this->out.matchesFile(this->fileName) || this->out.writeFile(this->fileName);
+            if(this->trace != nullptr){this->trace->add("flush", "phase", start);}
+            return written;
+        }
+
+        /**
+        * Renders the whole class into the output buffer
+        * without writing it. The result can be read with
+        * getOutput until the next class is rendered.
+        * @return void
+        */
+        void renderClass()
+        {
+            this->out.clear();
+            this->out.reserve(8192 + this->Fields.size() * 512);
+            int64_t start = this->trace != nullptr ? this->trace->now() : 0;
+            this->buildContext();
+            if(this->trace != nullptr){this->trace->add("buildContext", "phase", start);}
+            this->renderPart(PHPTemplateSet::Opening, &PHPBuilder::opening, "Creating opening.\n");
+            this->createSharedProperties();
+            this->renderPart(PHPTemplateSet::Constructor, &PHPBuilder::createConstructor, "Creating Constructor.\n");
+            if(this->options.statementCache)
+            {
+                this->renderPart(PHPTemplateSet::StatementCache, &PHPBuilder::createStatementCache, "Creating Statement Cache.\n");
+            }
+            this->renderPart(PHPTemplateSet::Read, &PHPBuilder::createRead, "Creating Read Method.\n");
+            this->renderPart(PHPTemplateSet::ReadOne, &PHPBuilder::createReadOne, "Creating ReadOne Method.\n");
+            this->renderPart(PHPTemplateSet::ReadColumns, &PHPBuilder::createReadColumns, "Creating ReadColumns Method.\n");
+            this->renderPart(PHPTemplateSet::ReadPaging, &PHPBuilder::createReadPaging, "Creating ReadPaging Method.\n");
+            this->renderPart(PHPTemplateSet::ReadAfter, &PHPBuilder::createReadAfter, "Creating ReadAfter Method.\n");
+            if(!this->context.finders.empty())
+            {
+                this->renderPart(PHPTemplateSet::FindBy, &PHPBuilder::createFindBy, "Creating FindBy Methods.\n");
+            }
+            this->renderPart(PHPTemplateSet::Iterate, &PHPBuilder::createIterate, "Creating Iterate Method.\n");
+            this->renderPart(PHPTemplateSet::Hydrate, &PHPBuilder::createHydrate, "Creating Hydrate Methods.\n");
+            this->renderPart(PHPTemplateSet::Count, &PHPBuilder::createCount, "Creating Count Method.\n");
+            if(this->options.approxCount)
+            {
+                this->renderPart(PHPTemplateSet::CountApprox, &PHPBuilder::createCountApprox, "Creating CountApprox Method.\n");
+                this->renderPart(PHPTemplateSet::CountCached, &PHPBuilder::createCountCached, "Creating CountCached Method.\n");
+            }
+            this->renderPart(PHPTemplateSet::CheckIfExists, &PHPBuilder::createCheckIfExists, "Creating CheckIfExists Method.\n");
+            this->renderPart(PHPTemplateSet::ExistsMany, &PHPBuilder::createExistsMany, "Creating ExistsMany Method.\n");
+            this->renderPart(PHPTemplateSet::Insert, &PHPBuilder::createInsert, "Creating Insert Method.\n");
+            this->renderPart(PHPTemplateSet::InsertMany, &PHPBuilder::createInsertMany, "Creating InsertMany Method.\n");
+            this->renderPart(PHPTemplateSet::Update, &PHPBuilder::createUpdate, "Creating Update Method.\n");
+            this->renderPart(PHPTemplateSet::Remove, &PHPBuilder::createRemove, "Creating Remove Method.\n");
+            this->renderPart(PHPTemplateSet::RemoveMany, &PHPBuilder::createRemoveMany, "Creating RemoveMany Method.\n");
+            this->renderPart(PHPTemplateSet::Closing, &PHPBuilder::closing, "Creating Closing Method.\n");
         }
 
         /**
@@ -764,12 +2233,37 @@ class PHPBuilder
             this->createClassComment();
             this->out << "\tclass " << this->className << "\n";
             this->out << "\t{\n";
-            for(std::string f : this->Fields)
+            for(std::string_view f : this->Fields)
             {
                 this->out << "\t\tpublic $" << f << ";\n";
             }
             this->out << "\t\tprivate $conn;\n";
             this->out << "\t\tprivate $table_name = \"" << this->tableName << "\";\n";
+        }
+
+        /**
+        * Function that declares the constants and the
+        * static and private properties the generated
+        * methods rely on.
+        * Written after the opening part, whether or not
+        * it comes from a template, so an Opening template
+        * only declares the fields, connection and table.
+        * @return void
+        */
+        void createSharedProperties()
+        {
+            this->out << "\t\tconst COLUMNS = [" << this->context.columnArray << "];\n";
+            this->out << "\t\tprivate $snapshot = [];\n";
+            if(this->options.statementCache)
+            {
+                this->out << "\t\tprivate static $statements = [];\n";
+                this->out << "\t\tpublic static $cacheStatements = true;\n";
+            }
+            if(this->options.approxCount)
+            {
+                this->out << "\t\tprivate static $counts = [];\n";
+            }
             this->out << "\n";
         }
-};
\ No newline at end of file
+};
+#endif
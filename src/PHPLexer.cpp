@@ -0,0 +1 @@
+#include "PHPLexer.h"
\ No newline at end of file
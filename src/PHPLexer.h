@@ -0,0 +1,266 @@
+#ifndef PHPLEXER_H
+#define PHPLEXER_H
+#include <string>
+#include <string_view>
+#include <vector>
+/*******************************************************************************
+ * PHPLexer
+ *
+ * Single pass tokenizer for the subset of PHP found in input class files.
+ * Reads a buffer once from start to end, skipping whitespace and comments,
+ * and hands back identifiers, variables, strings and symbols along with
+ * the line and column each one starts on. Token text points into the buffer
+ * rather than being copied.
+ *
+ *******************************************************************************/
+
+/**
+ * A message about an input file tied to the line and
+ * column where the problem was found
+ */
+struct PHPDiagnostic
+{
+    int line; /**< Line of the problem (1 based) */
+    int column; /**< Column of the problem (1 based) */
+    std::string message; /**< Description of the problem */
+};
+
+/**
+ * A single token read from a PHP input buffer
+ */
+struct PHPToken
+{
+    /**
+     * Kinds of tokens produced by the lexer
+     */
+    enum Type { Identifier, Variable, String, Number, Symbol, End };
+
+    Type type; /**< Kind of token */
+    std::string_view text; /**< Token text, without the $ or surrounding quotes, pointing into the buffer */
+    int line; /**< Line the token starts on (1 based) */
+    int column; /**< Column the token starts on (1 based) */
+
+    /**
+     * Checks if the token is the given symbol character
+     * @param c char
+     * @return bool
+     */
+    bool isSymbol(char c) const {return type == Symbol && text.size() == 1 && text[0] == c;}
+};
+
+class PHPLexer
+{
+    private:
+        std::string_view buffer; /**< Text being tokenized */
+        size_t pos = 0; /**< Offset of the next unread character */
+        int line = 1; /**< Line of the next unread character */
+        int column = 1; /**< Column of the next unread character */
+        std::vector<PHPDiagnostic> diagnostics; /**< Problems found while reading */
+
+        /**
+         * Checks if a character can start an identifier
+         * @param c char
+         * @return bool
+         */
+        static bool isIdentifierStart(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+                    || c == '_' || static_cast<unsigned char>(c) >= 0x80;
+        }
+
+        /**
+         * Checks if a character can continue an identifier.
+         * Backslashes are included so namespaced type names
+         * are read as one token.
+         * @param c char
+         * @return bool
+         */
+        static bool isIdentifierChar(char c)
+        {
+            return isIdentifierStart(c) || (c >= '0' && c <= '9') || c == '\\';
+        }
+
+        /**
+         * Returns the character at an offset from the current
+         * position or 0 if that is past the end of the buffer
+         * @param offset size_t
+         * @return char
+         */
+        char peek(size_t offset = 0) const
+        {
+            return pos + offset < this->buffer.size() ? this->buffer[pos + offset] : '\0';
+        }
+
+        /**
+         * Moves past the current character, keeping the
+         * line and column up to date
+         * @return void
+         */
+        void advance()
+        {
+            if(this->buffer[pos] == '\n')
+            {
+                line++;
+                column = 1;
+            }
+            else
+            {
+                column++;
+            }
+            pos++;
+        }
+
+        /**
+         * Skips whitespace, //, # and block comments
+         * @return void
+         */
+        void skipWhitespaceAndComments()
+        {
+            while(pos < this->buffer.size())
+            {
+                char c = this->peek();
+                if(c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v')
+                {
+                    this->advance();
+                }
+                else if(c == '#' || (c == '/' && this->peek(1) == '/'))
+                {
+                    while(pos < this->buffer.size() && this->peek() != '\n')
+                    {
+                        //a line comment also ends at a closing php tag
+                        if(this->peek() == '?' && this->peek(1) == '>'){return;}
+                        this->advance();
+                    }
+                }
+                else if(c == '/' && this->peek(1) == '*')
+                {
+                    int startLine = line;
+                    int startColumn = column;
+                    this->advance();
+                    this->advance();
+                    while(pos < this->buffer.size() && !(this->peek() == '*' && this->peek(1) == '/'))
+                    {
+                        this->advance();
+                    }
+                    if(pos < this->buffer.size())
+                    {
+                        this->advance();
+                        this->advance();
+                    }
+                    else
+                    {
+                        this->diagnostics.push_back({startLine, startColumn, "unterminated comment"});
+                    }
+                }
+                else
+                {
+                    return;
+                }
+            }
+        }
+
+        /**
+         * Reads a single or double quoted string starting at
+         * the current position. Escape sequences are kept as
+         * written.
+         * @param token PHPToken to fill
+         * @return void
+         */
+        void readString(PHPToken &token)
+        {
+            char quote = this->peek();
+            this->advance();
+            size_t start = pos;
+            while(pos < this->buffer.size() && this->peek() != quote)
+            {
+                if(this->peek() == '\\' && pos + 1 < this->buffer.size())
+                {
+                    this->advance();
+                }
+                this->advance();
+            }
+            token.text = this->buffer.substr(start, pos - start);
+            if(pos < this->buffer.size())
+            {
+                this->advance();
+            }
+            else
+            {
+                this->diagnostics.push_back({token.line, token.column, "unterminated string"});
+            }
+        }
+
+    public:
+        /**
+         * Constructor that takes the buffer to tokenize.
+         * The buffer is not copied and must outlive the lexer.
+         * @param buffer a string_view of the input text
+         */
+        PHPLexer(std::string_view buffer) : buffer(buffer) {}
+
+        /**
+         * Reads the next token from the buffer. Returns a
+         * token of type End once the buffer is exhausted.
+         * @return PHPToken
+         */
+        PHPToken next()
+        {
+            this->skipWhitespaceAndComments();
+            PHPToken token = {PHPToken::End, "", line, column};
+            if(pos >= this->buffer.size())
+            {
+                return token;
+            }
+            char c = this->peek();
+            size_t start = pos;
+            if(c == '$' && isIdentifierStart(this->peek(1)))
+            {
+                token.type = PHPToken::Variable;
+                this->advance();
+                start = pos;
+                while(pos < this->buffer.size() && isIdentifierChar(this->peek()))
+                {
+                    this->advance();
+                }
+                token.text = this->buffer.substr(start, pos - start);
+            }
+            else if(isIdentifierStart(c) || c == '\\')
+            {
+                token.type = PHPToken::Identifier;
+                while(pos < this->buffer.size() && isIdentifierChar(this->peek()))
+                {
+                    this->advance();
+                }
+                token.text = this->buffer.substr(start, pos - start);
+            }
+            else if(c >= '0' && c <= '9')
+            {
+                token.type = PHPToken::Number;
+                while(pos < this->buffer.size() && (isIdentifierChar(this->peek()) || this->peek() == '.'))
+                {
+                    this->advance();
+                }
+                token.text = this->buffer.substr(start, pos - start);
+            }
+            else if(c == '"' || c == '\'')
+            {
+                token.type = PHPToken::String;
+                this->readString(token);
+            }
+            else
+            {
+                token.type = PHPToken::Symbol;
+                token.text = this->buffer.substr(pos, 1);
+                this->advance();
+            }
+            return token;
+        }
+
+        /**
+         * Getter
+         * Retrieves the problems found while reading
+         * @return vector of PHPDiagnostic
+         */
+        const std::vector<PHPDiagnostic> &getDiagnostics() const {return this->diagnostics;}
+};
+#endif
@@ -0,0 +1 @@
+#include "PHPParser.h"
\ No newline at end of file
@@ -0,0 +1,437 @@
+#ifndef PHPPARSER_H
+#define PHPPARSER_H
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "PHPBuilder.h"
+#include "PHPLexer.h"
+#include "Tracer.h"
+/*******************************************************************************
+ * PHPParser
+ *
+ * Reads the tokens of an input PHP class file in a single scan and collects
+ * the class name, public properties and table_name needed to build a
+ * PHPBuilder, along with the optional sort_key used for keyset paging and
+ * soft_delete column. Problems are recorded as diagnostics with line and
+ * column.
+ * Braces are counted so each class only gets the properties declared in its
+ * own body, and a file may hold any number of classes. Each model is handed
+ * over as soon as the closing brace of its class is read, so a bundle of
+ * classes is generated while it is scanned instead of being collected first.
+ * The model handed to PHPBuilder points into the parsed buffer, which must
+ * outlive the builder's use of it.
+ *
+ *******************************************************************************/
+class PHPParser
+{
+    public:
+        using ModelCallback = std::function<void(PHPBuilder &php)>; /**< Receives each class while its model is valid */
+
+    private:
+        std::vector<PHPDiagnostic> diagnostics; /**< Problems found since the last class */
+        size_t lexerDiagnostics = 0; /**< Problems of the lexer already moved to diagnostics */
+        size_t classCount = 0; /**< Classes completed in the last parse */
+        TraceBuffer *trace = nullptr; /**< Buffer the parse of each class is recorded into, null for none */
+        std::string_view className; /**< Name of the parsed class */
+        std::vector<std::string_view> fields; /**< Public properties of the parsed class */
+        std::vector<std::string_view> fieldTypes; /**< Declared type of each public property, empty if untyped */
+        std::string_view tableName; /**< Value of the table_name property */
+        std::string_view sortKey; /**< Value of the sort_key property, empty if not set */
+        PHPToken sortKeyToken; /**< Where sort_key was declared */
+        std::vector<std::string_view> sortKeys; /**< Columns listed in sort_key */
+        std::string_view softDelete; /**< Value of the soft_delete property, empty if not set */
+        PHPToken softDeleteToken; /**< Where soft_delete was declared */
+
+        /**
+         * Compares an identifier with a keyword ignoring
+         * case, as PHP keywords are case insensitive
+         * @param text string
+         * @param keyword string in lower case
+         * @return bool
+         */
+        static bool isKeyword(std::string_view text, std::string_view keyword)
+        {
+            if(text.size() != keyword.size()){return false;}
+            for(size_t i = 0; i < text.size(); i++)
+            {
+                if(tolower(static_cast<unsigned char>(text[i])) != keyword[i]){return false;}
+            }
+            return true;
+        }
+
+        /**
+         * Splits the comma separated columns of sort_key into
+         * sortKeys. Columns that are not public properties are
+         * reported and left out.
+         * @return void
+         */
+        void parseSortKey()
+        {
+            size_t start = 0;
+            while(start <= this->sortKey.size())
+            {
+                size_t end = std::min(this->sortKey.find(',', start), this->sortKey.size());
+                std::string_view column = this->sortKey.substr(start, end - start);
+                while(!column.empty() && column.front() == ' '){column.remove_prefix(1);}
+                while(!column.empty() && column.back() == ' '){column.remove_suffix(1);}
+                if(std::find(this->fields.begin(), this->fields.end(), column) != this->fields.end())
+                {
+                    this->sortKeys.push_back(column);
+                }
+                else
+                {
+                    this->diagnostics.push_back({this->sortKeyToken.line, this->sortKeyToken.column,
+                        "sort_key column '" + std::string(column) + "' is not a public property"});
+                }
+                start = end + 1;
+            }
+        }
+
+        /**
+         * Reads a property declaration after its visibility
+         * keyword. Handles modifiers, optional types, default
+         * values and comma separated declarations. Returns the
+         * first token that is not part of the declaration.
+         * The declared type, such as ?int or string|null, is
+         * kept for each public property.
+         * @param lexer PHPLexer
+         * @param visibility PHPToken for public, private, protected or var
+         * @return PHPToken
+         */
+        PHPToken parseProperty(PHPLexer &lexer, const PHPToken &visibility)
+        {
+            bool isPublic = isKeyword(visibility.text, "public") || isKeyword(visibility.text, "var");
+            PHPToken t = lexer.next();
+            //modifiers and type, e.g. static ?int or readonly Foo|null
+            const char *typeStart = nullptr;
+            const char *typeEnd = nullptr;
+            while(t.type == PHPToken::Identifier || t.isSymbol('?') || t.isSymbol('|'))
+            {
+                if(isKeyword(t.text, "function") || isKeyword(t.text, "const"))
+                {
+                    return t;
+                }
+                if(!isKeyword(t.text, "static") && !isKeyword(t.text, "readonly"))
+                {
+                    if(typeStart == nullptr){typeStart = t.text.data();}
+                    typeEnd = t.text.data() + t.text.size();
+                }
+                t = lexer.next();
+            }
+            std::string_view type;
+            if(typeStart != nullptr)
+            {
+                type = std::string_view(typeStart, typeEnd - typeStart);
+            }
+            while(t.type == PHPToken::Variable)
+            {
+                PHPToken name = t;
+                std::string_view value;
+                t = lexer.next();
+                if(t.isSymbol('='))
+                {
+                    int depth = 0;
+                    bool first = true;
+                    t = lexer.next();
+                    while(t.type != PHPToken::End
+                        && !(depth == 0 && (t.isSymbol(';') || t.isSymbol(',') || t.isSymbol('}'))))
+                    {
+                        if(first && t.type == PHPToken::String){value = t.text;}
+                        if(t.isSymbol('(') || t.isSymbol('[')){depth++;}
+                        if(t.isSymbol(')') || t.isSymbol(']')){depth--;}
+                        first = false;
+                        t = lexer.next();
+                    }
+                }
+                if(isPublic)
+                {
+                    this->fields.push_back(name.text);
+                    this->fieldTypes.push_back(type);
+                }
+                if(name.text == "table_name")
+                {
+                    if(value.empty())
+                    {
+                        this->diagnostics.push_back({name.line, name.column,
+                            "table_name should be set to a quoted string"});
+                    }
+                    this->tableName = value;
+                }
+                if(name.text == "sort_key" && !isPublic)
+                {
+                    this->sortKey = value;
+                    this->sortKeyToken = name;
+                }
+                if(name.text == "soft_delete" && !isPublic)
+                {
+                    this->softDelete = value;
+                    this->softDeleteToken = name;
+                }
+                if(t.isSymbol(','))
+                {
+                    t = lexer.next();
+                    continue;
+                }
+                if(t.isSymbol(';'))
+                {
+                    return lexer.next();
+                }
+                this->diagnostics.push_back({t.line, t.column,
+                    "expected ';' after property $" + std::string(name.text)});
+                return t;
+            }
+            return t;
+        }
+
+        /**
+         * Forgets the model of the previous class
+         * @return void
+         */
+        void resetClass()
+        {
+            this->className = {};
+            this->fields.clear();
+            this->fieldTypes.clear();
+            this->tableName = {};
+            this->sortKey = {};
+            this->sortKeys.clear();
+            this->softDelete = {};
+        }
+
+        /**
+         * Moves the problems the lexer found since the last
+         * call into diagnostics
+         * @param lexer PHPLexer
+         * @return void
+         */
+        void takeLexerDiagnostics(const PHPLexer &lexer)
+        {
+            const std::vector<PHPDiagnostic> &found = lexer.getDiagnostics();
+            for(; this->lexerDiagnostics < found.size(); this->lexerDiagnostics++)
+            {
+                this->diagnostics.push_back(found[this->lexerDiagnostics]);
+            }
+        }
+
+        /**
+         * Checks the class that has just ended and loads its
+         * model into the builder. Missing table_name is
+         * reported where the class ends.
+         * @param lexer PHPLexer
+         * @param end PHPToken that ended the class
+         * @param php PHPBuilder to load the model into
+         * @return void
+         */
+        void finishClass(const PHPLexer &lexer, const PHPToken &end, PHPBuilder &php)
+        {
+            this->takeLexerDiagnostics(lexer);
+            if(this->tableName.empty())
+            {
+                this->diagnostics.push_back({end.line, end.column, "no table_name property found"});
+            }
+            if(!this->sortKey.empty())
+            {
+                this->parseSortKey();
+            }
+            if(!this->softDelete.empty()
+                && std::find(this->fields.begin(), this->fields.end(), this->softDelete) == this->fields.end())
+            {
+                this->diagnostics.push_back({this->softDeleteToken.line, this->softDeleteToken.column,
+                    "soft_delete column '" + std::string(this->softDelete) + "' is not a public property"});
+                this->softDelete = {};
+            }
+            std::stable_sort(this->diagnostics.begin(), this->diagnostics.end(),
+                [](const PHPDiagnostic &a, const PHPDiagnostic &b)
+                {
+                    return a.line < b.line || (a.line == b.line && a.column < b.column);
+                });
+            php.setModel(this->className, this->fields, this->tableName);
+            php.setFieldTypes(this->fieldTypes);
+            php.setSortKeys(this->sortKeys);
+            php.setSoftDelete(this->softDelete);
+            php.setPrimaryKey({});
+            php.setIndexes({});
+        }
+
+        /**
+         * Scans a buffer for classes. A class is opened by
+         * class and its name and ends at the brace closing its
+         * body; only properties declared directly in the body
+         * belong to it. Each class is loaded into php and
+         * handed to onModel, after which its diagnostics are
+         * cleared. Without onModel the scan stops after the
+         * first class, and a buffer without classes loads an
+         * empty model. A class still open at the end of the
+         * buffer is reported and left out, as where its body
+         * ends cannot be told.
+         * @param buffer string_view of the input file contents
+         * @param php PHPBuilder to load each model into
+         * @param onModel ModelCallback, or null for the first class only
+         * @return void
+         */
+        void scan(std::string_view buffer, PHPBuilder &php, const ModelCallback *onModel)
+        {
+            this->diagnostics.clear();
+            this->lexerDiagnostics = 0;
+            this->classCount = 0;
+            this->resetClass();
+
+            PHPLexer lexer(buffer);
+            int depth = 0;
+            int classDepth = -1; //brace depth of the open class body, -1 outside of one
+            bool declared = false; //a class name was read and its body has not ended
+            bool afterScope = false;
+            int64_t start = this->trace != nullptr ? this->trace->now() : 0;
+            PHPToken t = lexer.next();
+            while(t.type != PHPToken::End)
+            {
+                //classes do not nest, so class inside one is an anonymous class or constant
+                if(t.type == PHPToken::Identifier && !afterScope && !declared && isKeyword(t.text, "class"))
+                {
+                    PHPToken name = lexer.next();
+                    if(name.type == PHPToken::Identifier)
+                    {
+                        this->resetClass();
+                        this->className = name.text;
+                        declared = true;
+                        t = lexer.next();
+                    }
+                    else
+                    {
+                        this->diagnostics.push_back({name.line, name.column, "expected a class name after 'class'"});
+                        t = name;
+                    }
+                    afterScope = false;
+                    continue;
+                }
+                if(t.isSymbol('{'))
+                {
+                    depth++;
+                    if(declared && classDepth < 0){classDepth = depth;}
+                }
+                else if(t.isSymbol('}') && depth > 0)
+                {
+                    if(depth == classDepth)
+                    {
+                        if(this->trace != nullptr){this->trace->add("parse", "phase", start);}
+                        this->finishClass(lexer, t, php);
+                        this->classCount++;
+                        declared = false;
+                        classDepth = -1;
+                        if(onModel == nullptr){return;}
+                        (*onModel)(php);
+                        this->diagnostics.clear();
+                        start = this->trace != nullptr ? this->trace->now() : 0;
+                    }
+                    depth--;
+                }
+                else if(t.type == PHPToken::Identifier && depth == classDepth
+                    && (isKeyword(t.text, "public") || isKeyword(t.text, "private")
+                        || isKeyword(t.text, "protected") || isKeyword(t.text, "var")))
+                {
+                    t = this->parseProperty(lexer, t);
+                    afterScope = false;
+                    continue;
+                }
+                //Foo::class is a constant, not a declaration
+                afterScope = t.isSymbol(':');
+                t = lexer.next();
+            }
+            this->takeLexerDiagnostics(lexer);
+            if(declared)
+            {
+                this->diagnostics.push_back({t.line, t.column,
+                    "missing '}' at the end of class " + std::string(this->className)});
+            }
+            else if(this->classCount == 0)
+            {
+                this->diagnostics.push_back({t.line, t.column, "no class declaration found"});
+            }
+            if(this->trace != nullptr && this->classCount == 0){this->trace->add("parse", "phase", start);}
+            if(this->classCount == 0 && onModel == nullptr)
+            {
+                this->resetClass();
+                this->finishClass(lexer, t, php);
+            }
+        }
+
+    public:
+        /**
+         * Parses a buffer holding an input PHP class and builds
+         * a PHPBuilder from the class name, public properties
+         * and table_name of the first class found in it.
+         * @param buffer string_view of the input file contents
+         * @return PHPBuilder
+         */
+        PHPBuilder parse(std::string_view buffer)
+        {
+            PHPBuilder php;
+            this->parse(buffer, php);
+            return php;
+        }
+
+        /**
+         * Parses a buffer holding an input PHP class and loads
+         * the class name, public properties, table_name, sort_key and
+         * soft_delete of the first class found
+         * in it into an existing PHPBuilder, so one parser and
+         * builder can be reused across many input files. The
+         * builder holds views into buffer, so buffer must stay
+         * alive until the class has been created.
+         * @param buffer string_view of the input file contents
+         * @param php PHPBuilder to load the model into
+         * @return void
+         */
+        void parse(std::string_view buffer, PHPBuilder &php)
+        {
+            this->scan(buffer, php, nullptr);
+        }
+
+        /**
+         * Parses a buffer holding any number of input PHP
+         * classes, loading each one into php and calling
+         * onModel with it as soon as its closing brace is read.
+         * During the call getDiagnostics holds the problems
+         * found since the previous class; after parse returns
+         * it holds those found after the last one. The model
+         * is only valid during the call.
+         * @param buffer string_view of the input file contents
+         * @param php PHPBuilder to load each model into
+         * @param onModel ModelCallback
+         * @return void
+         */
+        void parse(std::string_view buffer, PHPBuilder &php, const ModelCallback &onModel)
+        {
+            this->scan(buffer, php, &onModel);
+        }
+
+        /**
+         * Sets the buffer the parse of each class is
+         * recorded into as a span
+         * @param trace TraceBuffer, null for none
+         * @return void
+         */
+        void setTrace(TraceBuffer *trace)
+        {
+            this->trace = trace;
+        }
+
+        /**
+         * Getter
+         * Retrieves the number of classes found in the last
+         * parse
+         * @return size_t
+         */
+        size_t getClassCount() const {return this->classCount;}
+
+        /**
+         * Getter
+         * Retrieves the problems found since the last class,
+         * or in the last parse of a single class
+         * @return vector of PHPDiagnostic
+         */
+        const std::vector<PHPDiagnostic> &getDiagnostics() const {return this->diagnostics;}
+};
+#endif
@@ -0,0 +1 @@
+#include "PHPTemplate.h"
\ No newline at end of file
@@ -0,0 +1,349 @@
+#ifndef PHPTEMPLATE_H
+#define PHPTEMPLATE_H
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "OutputBuffer.h"
+/*******************************************************************************
+ * PHPTemplate
+ *
+ * A template for one generated method, compiled once into a flat list of
+ * literal segments and placeholders and then rendered for any number of
+ * models straight into an OutputBuffer.
+ *
+ * Tags are written between {{ and }}:
+ *   {{className}}       name of the class
+ *   {{classNameLower}}  name of the class in lower case
+ *   {{tableName}}       value of the table_name property
+ *   {{#fields}}...{{/fields}}  repeated once for every field
+ *   {{field}}           current field, only inside #fields
+ *   {{#first}}...{{/first}} and {{^first}}...{{/first}}
+ *   {{#last}}...{{/last}} and {{^last}}...{{/last}}
+ *                       rendered only for the first or last field (#), or
+ *                       for every other field (^), only inside #fields
+ *
+ *******************************************************************************/
+
+/**
+ * The values a template is rendered with
+ */
+struct PHPTemplateModel
+{
+    std::string_view className; /**< Name of the class */
+    std::string_view classNameLower; /**< Name of the class in lower case */
+    std::string_view tableName; /**< Name of the table */
+    const std::vector<std::string_view> *fields; /**< Properties of the class */
+};
+
+class PHPTemplate
+{
+    private:
+        /**
+         * Kinds of compiled segments
+         */
+        enum Tag { Literal, ClassName, ClassNameLower, TableName, Field,
+                   FieldsBegin, FirstBegin, NotFirstBegin, LastBegin, NotLastBegin, SectionEnd };
+
+        /**
+         * A piece of literal text or a placeholder
+         */
+        struct Segment
+        {
+            Tag tag; /**< Kind of segment */
+            size_t offset; /**< Start of the literal text in source */
+            size_t length; /**< Length of the literal text */
+            size_t end; /**< Index of the matching SectionEnd for section tags */
+        };
+
+        std::string source; /**< Text of the template */
+        std::vector<Segment> segments; /**< Compiled segments in order */
+
+        /**
+         * Renders segments [begin, end) with the given field as
+         * the current field
+         * @param out OutputBuffer to render into
+         * @param model PHPTemplateModel
+         * @param begin index of the first segment
+         * @param end index after the last segment
+         * @param field index of the current field, or -1 outside #fields
+         * @return void
+         */
+        void renderRange(OutputBuffer &out, const PHPTemplateModel &model, size_t begin, size_t end, long field) const
+        {
+            long last = (long)model.fields->size() - 1;
+            for(size_t i = begin; i < end; i++)
+            {
+                const Segment &segment = this->segments[i];
+                switch(segment.tag)
+                {
+                    case Literal:
+                        out << std::string_view(this->source).substr(segment.offset, segment.length);
+                        break;
+                    case ClassName:
+                        out << model.className;
+                        break;
+                    case ClassNameLower:
+                        out << model.classNameLower;
+                        break;
+                    case TableName:
+                        out << model.tableName;
+                        break;
+                    case Field:
+                        out << (*model.fields)[field];
+                        break;
+                    case FieldsBegin:
+                        for(long f = 0; f <= last; f++)
+                        {
+                            this->renderRange(out, model, i + 1, segment.end, f);
+                        }
+                        i = segment.end;
+                        break;
+                    case FirstBegin:
+                    case NotFirstBegin:
+                    case LastBegin:
+                    case NotLastBegin:
+                    {
+                        bool match = (segment.tag == FirstBegin && field == 0)
+                                    || (segment.tag == NotFirstBegin && field != 0)
+                                    || (segment.tag == LastBegin && field == last)
+                                    || (segment.tag == NotLastBegin && field != last);
+                        if(match)
+                        {
+                            this->renderRange(out, model, i + 1, segment.end, field);
+                        }
+                        i = segment.end;
+                        break;
+                    }
+                    case SectionEnd:
+                        break;
+                }
+            }
+        }
+
+    public:
+        /**
+         * Compiles template text. Returns false and sets error
+         * to a message with the line number if a tag is unknown,
+         * misplaced or not closed.
+         * @param text string
+         * @param error string to fill
+         * @return bool
+         */
+        bool compile(std::string text, std::string &error)
+        {
+            this->source = std::move(text);
+            this->segments.clear();
+            std::vector<std::pair<size_t, std::string>> open;
+            int fieldsDepth = 0;
+            size_t pos = 0;
+            int line = 1;
+            while(pos < this->source.size())
+            {
+                size_t tagStart = this->source.find("{{", pos);
+                size_t literalEnd = tagStart == std::string::npos ? this->source.size() : tagStart;
+                if(literalEnd > pos)
+                {
+                    this->segments.push_back({Literal, pos, literalEnd - pos, 0});
+                    for(size_t i = pos; i < literalEnd; i++){if(this->source[i] == '\n'){line++;}}
+                }
+                if(tagStart == std::string::npos)
+                {
+                    break;
+                }
+                size_t tagEnd = this->source.find("}}", tagStart + 2);
+                if(tagEnd == std::string::npos)
+                {
+                    error = "line " + std::to_string(line) + ": {{ is not closed with }}";
+                    return false;
+                }
+                std::string name = this->source.substr(tagStart + 2, tagEnd - tagStart - 2);
+                pos = tagEnd + 2;
+                Tag tag;
+                if(name == "className"){tag = ClassName;}
+                else if(name == "classNameLower"){tag = ClassNameLower;}
+                else if(name == "tableName"){tag = TableName;}
+                else if(name == "field"){tag = Field;}
+                else if(name == "#fields"){tag = FieldsBegin;}
+                else if(name == "#first"){tag = FirstBegin;}
+                else if(name == "^first"){tag = NotFirstBegin;}
+                else if(name == "#last"){tag = LastBegin;}
+                else if(name == "^last"){tag = NotLastBegin;}
+                else if(name == "/fields" || name == "/first" || name == "/last"){tag = SectionEnd;}
+                else
+                {
+                    error = "line " + std::to_string(line) + ": unknown tag {{" + name + "}}";
+                    return false;
+                }
+                if(tag == Field || tag == FirstBegin || tag == NotFirstBegin || tag == LastBegin || tag == NotLastBegin)
+                {
+                    if(fieldsDepth == 0)
+                    {
+                        error = "line " + std::to_string(line) + ": {{" + name + "}} is only allowed inside {{#fields}}";
+                        return false;
+                    }
+                }
+                if(tag == SectionEnd)
+                {
+                    if(open.empty() || open.back().second.substr(1) != name.substr(1))
+                    {
+                        error = "line " + std::to_string(line) + ": {{" + name + "}} does not close the open section";
+                        return false;
+                    }
+                    this->segments[open.back().first].end = this->segments.size();
+                    if(this->segments[open.back().first].tag == FieldsBegin){fieldsDepth--;}
+                    open.pop_back();
+                }
+                if(tag >= FieldsBegin && tag <= NotLastBegin)
+                {
+                    if(tag == FieldsBegin && fieldsDepth > 0)
+                    {
+                        error = "line " + std::to_string(line) + ": {{#fields}} cannot be nested";
+                        return false;
+                    }
+                    if(tag == FieldsBegin){fieldsDepth++;}
+                    open.push_back({this->segments.size(), name});
+                }
+                this->segments.push_back({tag, 0, 0, 0});
+            }
+            if(!open.empty())
+            {
+                error = "{{" + open.back().second + "}} is not closed";
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * Renders the template for a model into a buffer
+         * @param out OutputBuffer to render into
+         * @param model PHPTemplateModel
+         * @return void
+         */
+        void render(OutputBuffer &out, const PHPTemplateModel &model) const
+        {
+            this->renderRange(out, model, 0, this->segments.size(), -1);
+        }
+
+        /**
+         * Getter
+         * Retrieves the text the template was compiled from
+         * @return string_view
+         */
+        std::string_view getSource() const {return this->source;}
+};
+
+/*******************************************************************************
+ * PHPTemplateSet
+ *
+ * The templates loaded from a directory, one file per generated method named
+ * after the method, e.g. Read.tpl or Insert.tpl. Methods without a template
+ * are generated by PHPBuilder's built-in emitters.
+ *
+ *******************************************************************************/
+class PHPTemplateSet
+{
+    public:
+        /**
+         * Parts of a class that can be replaced by a template
+         */
+        enum Method { Opening, Constructor, StatementCache, Read, ReadOne, ReadColumns, ReadPaging,
+                      ReadAfter, FindBy, Iterate, Hydrate, Count, CountApprox, CountCached, CheckIfExists, ExistsMany,
+                      Insert, InsertMany, Update, Remove, RemoveMany, Closing, MethodCount };
+
+    private:
+        std::unique_ptr<PHPTemplate> templates[MethodCount]; /**< Compiled templates, null if not provided */
+        uint64_t hash = 0; /**< Hash of every loaded template */
+
+    public:
+        /**
+         * Retrieves the file name, without extension, of the
+         * template for a method
+         * @param method Method
+         * @return string
+         */
+        static const char *getMethodName(Method method)
+        {
+            static const char *names[MethodCount] = {"Opening", "Constructor", "StatementCache", "Read", "ReadOne",
+                                                     "ReadColumns", "ReadPaging", "ReadAfter", "FindBy", "Iterate", "Hydrate",
+                                                     "Count", "CountApprox", "CountCached", "CheckIfExists",
+                                                     "ExistsMany", "Insert", "InsertMany", "Update", "Remove",
+                                                     "RemoveMany", "Closing"};
+            return names[method];
+        }
+
+        /**
+         * Loads and compiles every .tpl file in a directory.
+         * Returns false and sets error if the directory cannot
+         * be read, a file is not named after a method or a
+         * template does not compile.
+         * @param directory a string argument.
+         * @param error string to fill
+         * @return bool
+         */
+        bool load(const std::string &directory, std::string &error)
+        {
+            std::error_code code;
+            std::vector<std::filesystem::path> files;
+            for(std::filesystem::directory_iterator it(directory, code), end; !code && it != end; it.increment(code))
+            {
+                if(it->is_regular_file() && it->path().extension() == ".tpl"){files.push_back(it->path());}
+            }
+            if(code)
+            {
+                error = directory + " could not be read";
+                return false;
+            }
+            std::sort(files.begin(), files.end());
+            this->hash = 14695981039346656037ULL;
+            for(const std::filesystem::path &file : files)
+            {
+                std::string stem = file.stem().string();
+                int method = 0;
+                while(method < MethodCount && stem != getMethodName((Method)method)){method++;}
+                if(method == MethodCount)
+                {
+                    error = file.string() + " is not named after a generated method";
+                    return false;
+                }
+                std::ifstream input(file);
+                std::stringstream text;
+                text << input.rdbuf();
+                auto compiled = std::make_unique<PHPTemplate>();
+                std::string message;
+                if(!input.is_open() || !compiled->compile(text.str(), message))
+                {
+                    error = file.string() + ": " + (message.empty() ? "could not be read" : message);
+                    return false;
+                }
+                for(unsigned char c : stem + '\n' + std::string(compiled->getSource()))
+                {
+                    this->hash = (this->hash ^ c) * 1099511628211ULL;
+                }
+                this->templates[method] = std::move(compiled);
+            }
+            return true;
+        }
+
+        /**
+         * Getter
+         * Retrieves the template for a method
+         * @param method Method
+         * @return PHPTemplate, null if the method has no template
+         */
+        const PHPTemplate *get(Method method) const {return this->templates[method].get();}
+
+        /**
+         * Getter
+         * Retrieves a hash of every loaded template, used so
+         * cached outputs are regenerated when templates change
+         * @return uint64_t
+         */
+        uint64_t getHash() const {return this->hash;}
+};
+#endif
@@ -0,0 +1 @@
+#include "SQLiteSchema.h"
\ No newline at end of file
@@ -0,0 +1,344 @@
+#ifndef SQLITESCHEMA_H
+#define SQLITESCHEMA_H
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DDLParser.h"
+#include "PHPBuilder.h"
+#include "StringArena.h"
+#include "Tracer.h"
+#ifdef HAVE_SQLITE3
+#include <sqlite3.h>
+#endif
+/*******************************************************************************
+ * SQLiteSchema
+ *
+ * Reads the tables of a SQLite database from sqlite_master and builds a
+ * PHPBuilder model for each from PRAGMA table_info, index_list and
+ * index_info: the class name derived from the table name as for --ddl, the
+ * columns as fields with the PHP type of their declared type's affinity,
+ * the primary key and every index usable for lookups. The database is
+ * opened read-only. Each model is handed to a callback as soon as it is
+ * built and is only valid during the call.
+ * Only available when built with SQLite (HAVE_SQLITE3).
+ *
+ *******************************************************************************/
+class SQLiteSchema
+{
+    public:
+        using ModelCallback = std::function<void(PHPBuilder &php)>; /**< Receives each model while it is valid */
+
+    private:
+        std::vector<std::string> warnings; /**< Problems found since the last model */
+        StringArena arena; /**< Names of the current model */
+        std::string_view className; /**< Class name of the current model */
+        std::string_view tableName; /**< Table name of the current model */
+        std::vector<std::string_view> fields; /**< Columns of the current model */
+        std::vector<std::string_view> fieldTypes; /**< PHP type of each column */
+        std::vector<std::string_view> primaryKey; /**< Primary key columns in key order */
+        std::vector<PHPIndex> indexes; /**< Indexes of the current model */
+        size_t tableCount = 0; /**< Models handed to the callback */
+        TraceBuffer *trace = nullptr; /**< Buffer the reading of each table is recorded into, null for none */
+
+        /**
+         * Maps a declared SQLite column type to the PHP type
+         * rows of the column are converted to, following the
+         * type affinity rules of SQLite, nullable unless the
+         * column is NOT NULL. Columns with BLOB or NUMERIC
+         * affinity can hold values of any type and are not
+         * converted.
+         * @param type string_view of the declared type
+         * @param notNull bool
+         * @return string_view
+         */
+        static std::string_view getPHPType(std::string_view type, bool notNull)
+        {
+            std::string upper(type);
+            for(char &c : upper)
+            {
+                c = toupper(static_cast<unsigned char>(c));
+            }
+            auto has = [&upper](const char *part){return upper.find(part) != std::string::npos;};
+            //BOOLEAN has NUMERIC affinity but only holds 0 and 1
+            if(has("BOOL")){return notNull ? "bool" : "?bool";}
+            if(has("INT")){return notNull ? "int" : "?int";}
+            if(has("CHAR") || has("CLOB") || has("TEXT")){return notNull ? "string" : "?string";}
+            if(has("REAL") || has("FLOA") || has("DOUB")){return notNull ? "float" : "?float";}
+            return {};
+        }
+
+        /**
+         * Retrieves the field a column is read into. A
+         * column named id in any case becomes the ID field
+         * the generated methods look records up by.
+         * @param column string_view
+         * @return string_view
+         */
+        std::string_view getField(std::string_view column)
+        {
+            if(column.size() == 2 && tolower(static_cast<unsigned char>(column[0])) == 'i'
+                && tolower(static_cast<unsigned char>(column[1])) == 'd')
+            {
+                return "ID";
+            }
+            return this->arena.store(column);
+        }
+
+#ifdef HAVE_SQLITE3
+        /**
+         * Retrieves a text column of the current row of a
+         * statement, empty if it is null
+         * @param stmt sqlite3_stmt
+         * @param column int
+         * @return string_view
+         */
+        static std::string_view getText(sqlite3_stmt *stmt, int column)
+        {
+            const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, column));
+            return text != nullptr ? std::string_view(text, sqlite3_column_bytes(stmt, column)) : std::string_view();
+        }
+
+        /**
+         * Reads the columns of the current table into
+         * fields, field types and primary key. Columns whose
+         * names cannot be PHP properties are left out.
+         * @param columns prepared pragma_table_info statement
+         * @return void
+         */
+        void readColumns(sqlite3_stmt *columns)
+        {
+            std::vector<std::pair<int, std::string_view>> keyColumns;
+            while(sqlite3_step(columns) == SQLITE_ROW)
+            {
+                std::string_view name = getText(columns, 0);
+                std::string_view type = getText(columns, 1);
+                bool notNull = sqlite3_column_int(columns, 2) != 0;
+                int keyPosition = sqlite3_column_int(columns, 3);
+                if(!DDLParser::isPHPIdentifier(name))
+                {
+                    this->warnings.push_back("column '" + std::string(name) + "' of table '"
+                        + std::string(this->tableName) + "' is not a valid PHP property name, skipped");
+                    continue;
+                }
+                std::string_view field = this->getField(name);
+                //an INTEGER PRIMARY KEY is the rowid and never null
+                bool rowid = keyPosition > 0 && type.size() == 7
+                             && std::equal(type.begin(), type.end(), "INTEGER",
+                                           [](char a, char b){return toupper(static_cast<unsigned char>(a)) == b;});
+                this->fields.push_back(field);
+                this->fieldTypes.push_back(getPHPType(type, notNull || rowid));
+                if(keyPosition > 0)
+                {
+                    keyColumns.push_back({keyPosition, field});
+                }
+            }
+            std::sort(keyColumns.begin(), keyColumns.end());
+            for(const std::pair<int, std::string_view> &k : keyColumns)
+            {
+                this->primaryKey.push_back(k.second);
+            }
+        }
+
+        /**
+         * Reads the indexes of the current table. Partial
+         * indexes, indexes on expressions or on left out
+         * columns and the index of the primary key, which
+         * is already known, are left out.
+         * @param list prepared pragma_index_list statement
+         * @param info prepared pragma_index_info statement
+         * @return void
+         */
+        void readIndexes(sqlite3_stmt *list, sqlite3_stmt *info)
+        {
+            while(sqlite3_step(list) == SQLITE_ROW)
+            {
+                std::string_view name = getText(list, 0);
+                bool unique = sqlite3_column_int(list, 1) != 0;
+                std::string_view origin = getText(list, 2);
+                bool partial = sqlite3_column_int(list, 3) != 0;
+                if(partial || origin == "pk")
+                {
+                    continue;
+                }
+                PHPIndex index;
+                index.name = this->arena.store(name);
+                index.unique = unique;
+                sqlite3_reset(info);
+                sqlite3_bind_text(info, 1, name.data(), name.size(), SQLITE_TRANSIENT);
+                bool usable = true;
+                while(sqlite3_step(info) == SQLITE_ROW)
+                {
+                    //expressions and the rowid have no column name
+                    std::string_view column = getText(info, 0);
+                    std::string_view field = column.empty() ? column : this->getField(column);
+                    if(field.empty() || std::find(this->fields.begin(), this->fields.end(), field) == this->fields.end())
+                    {
+                        usable = false;
+                    }
+                    index.columns.push_back(field);
+                }
+                if(usable && !index.columns.empty())
+                {
+                    this->indexes.push_back(std::move(index));
+                }
+            }
+        }
+#endif
+
+    public:
+        /**
+         * Checks if this build can read SQLite databases
+         * @return bool
+         */
+        static bool isSupported()
+        {
+#ifdef HAVE_SQLITE3
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * Sets the buffer the reading of every table is
+         * recorded into. Null, the default, records none.
+         * @param trace TraceBuffer
+         * @return void
+         */
+        void setTrace(TraceBuffer *trace)
+        {
+            this->trace = trace;
+        }
+
+        /**
+         * Reads every table of a SQLite database, calling
+         * onModel with the model of each in name order. The
+         * builder is loaded with each model before the call
+         * and the model is only valid during it. Warnings
+         * found since the previous model can be read in the
+         * callback and are cleared after it. Returns false
+         * and sets error if the database could not be read.
+         * @param fileName string
+         * @param php PHPBuilder models are loaded into
+         * @param onModel ModelCallback
+         * @param error string
+         * @return bool
+         */
+        bool load(const std::string &fileName, PHPBuilder &php, const ModelCallback &onModel, std::string &error)
+        {
+            this->warnings.clear();
+            this->tableCount = 0;
+#ifdef HAVE_SQLITE3
+            sqlite3 *db = nullptr;
+            if(sqlite3_open_v2(fileName.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+            {
+                error = db != nullptr ? sqlite3_errmsg(db) : "out of memory";
+                sqlite3_close(db);
+                return false;
+            }
+            sqlite3_stmt *tables = nullptr;
+            sqlite3_stmt *columns = nullptr;
+            sqlite3_stmt *list = nullptr;
+            sqlite3_stmt *info = nullptr;
+            //the pragma functions take the table as a parameter, so names need no quoting
+            bool prepared =
+                sqlite3_prepare_v2(db, "SELECT name FROM sqlite_master WHERE type = 'table' "
+                                       "AND name NOT LIKE 'sqlite\\_%' ESCAPE '\\' ORDER BY name", -1, &tables, nullptr) == SQLITE_OK
+                && sqlite3_prepare_v2(db, "SELECT name, type, \"notnull\", pk FROM pragma_table_info(?) ORDER BY cid",
+                                      -1, &columns, nullptr) == SQLITE_OK
+                && sqlite3_prepare_v2(db, "SELECT name, \"unique\", origin, partial FROM pragma_index_list(?) ORDER BY name",
+                                      -1, &list, nullptr) == SQLITE_OK
+                && sqlite3_prepare_v2(db, "SELECT name FROM pragma_index_info(?) ORDER BY seqno",
+                                      -1, &info, nullptr) == SQLITE_OK;
+            if(!prepared)
+            {
+                error = sqlite3_errmsg(db);
+            }
+            //the table names are copied as reading each table reuses the statements
+            std::vector<std::string> names;
+            int step = SQLITE_DONE;
+            while(prepared && (step = sqlite3_step(tables)) == SQLITE_ROW)
+            {
+                names.push_back(std::string(getText(tables, 0)));
+            }
+            if(prepared && step != SQLITE_DONE)
+            {
+                error = sqlite3_errmsg(db);
+                prepared = false;
+            }
+            for(size_t i = 0; prepared && i < names.size(); i++)
+            {
+                int64_t start = this->trace != nullptr ? this->trace->now() : 0;
+                this->arena.clear();
+                this->fields.clear();
+                this->fieldTypes.clear();
+                this->primaryKey.clear();
+                this->indexes.clear();
+                this->tableName = this->arena.store(names[i]);
+                this->className = this->arena.store(DDLParser::toClassName(this->tableName));
+                sqlite3_reset(columns);
+                sqlite3_bind_text(columns, 1, names[i].c_str(), names[i].size(), SQLITE_STATIC);
+                this->readColumns(columns);
+                sqlite3_reset(list);
+                sqlite3_bind_text(list, 1, names[i].c_str(), names[i].size(), SQLITE_STATIC);
+                this->readIndexes(list, info);
+                if(this->trace != nullptr){this->trace->add("parse", "phase", start);}
+                if(!DDLParser::isPHPIdentifier(this->className) || DDLParser::isReserved(this->className))
+                {
+                    this->warnings.push_back("class name '" + std::string(this->className) + "' of table '"
+                        + names[i] + "' is not a valid PHP class name, skipped");
+                    continue;
+                }
+                if(this->fields.empty())
+                {
+                    this->warnings.push_back("table '" + names[i] + "' has no usable columns, skipped");
+                    continue;
+                }
+                if(std::find(this->fields.begin(), this->fields.end(), "ID") == this->fields.end())
+                {
+                    this->warnings.push_back("table '" + names[i]
+                        + "' has no id column, methods that find records by ID will not work");
+                }
+                php.setModel(this->className, this->fields, this->tableName);
+                php.setFieldTypes(this->fieldTypes);
+                php.setSortKeys({});
+                php.setSoftDelete({});
+                php.setPrimaryKey(this->primaryKey);
+                php.setIndexes(this->indexes);
+                this->tableCount++;
+                onModel(php);
+                this->warnings.clear();
+            }
+            sqlite3_finalize(tables);
+            sqlite3_finalize(columns);
+            sqlite3_finalize(list);
+            sqlite3_finalize(info);
+            sqlite3_close(db);
+            return prepared;
+#else
+            (void)fileName;
+            (void)php;
+            (void)onModel;
+            error = "this build has no SQLite support";
+            return false;
+#endif
+        }
+
+        /**
+         * Getter
+         * Retrieves the problems found since the last model
+         * @return vector of strings
+         */
+        const std::vector<std::string> &getWarnings() const {return this->warnings;}
+
+        /**
+         * Getter
+         * Retrieves the number of models handed to the
+         * callback by the last load
+         * @return size_t
+         */
+        size_t getTableCount() const {return this->tableCount;}
+};
+#endif
@@ -0,0 +1 @@
+#include "StringArena.h"
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+/*******************************************************************************
+ * StringArena
+ *
+ * Owns strings that are built while parsing, such as class names derived
+ * from table names, so models can hold string_views to them the same way
+ * they hold views into a mapped input file. Strings are copied into large
+ * blocks instead of being allocated one by one, and clear releases all of
+ * them at once while keeping the first block for reuse.
+ *
+ *******************************************************************************/
+class StringArena
+{
+    private:
+        static constexpr size_t blockSize = 16384; /**< Bytes of a regular block */
+        std::vector<std::unique_ptr<char[]>> blocks; /**< Blocks in the order they were allocated */
+        size_t used = 0; /**< Bytes used in the last block */
+        size_t capacity = 0; /**< Size of the last block */
+        size_t firstCapacity = 0; /**< Size of the first block */
+
+    public:
+        /**
+         * Copies text into the arena
+         * @param text string_view
+         * @return string_view of the copy, valid until clear
+         */
+        std::string_view store(std::string_view text)
+        {
+            if(text.empty())
+            {
+                return {};
+            }
+            if(this->blocks.empty() || this->capacity - this->used < text.size())
+            {
+                //strings larger than a block get a block of their own
+                this->capacity = std::max(blockSize, text.size());
+                this->blocks.push_back(std::make_unique<char[]>(this->capacity));
+                if(this->blocks.size() == 1){this->firstCapacity = this->capacity;}
+                this->used = 0;
+            }
+            char *copy = this->blocks.back().get() + this->used;
+            std::memcpy(copy, text.data(), text.size());
+            this->used += text.size();
+            return std::string_view(copy, text.size());
+        }
+
+        /**
+         * Releases every stored string. The first block
+         * is kept for reuse if it has the regular size.
+         * @return void
+         */
+        void clear()
+        {
+            this->blocks.resize(std::min<size_t>(this->blocks.size(), 1));
+            this->used = 0;
+            this->capacity = this->blocks.empty() ? 0 : this->firstCapacity;
+            if(this->capacity != blockSize)
+            {
+                this->blocks.clear();
+                this->capacity = 0;
+            }
+        }
+};
+#endif
@@ -0,0 +1 @@
+#include "ThreadPool.h"
\ No newline at end of file
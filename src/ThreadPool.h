@@ -0,0 +1,164 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+/*******************************************************************************
+ * ThreadPool
+ *
+ * Work-stealing pool for a fixed batch of independent tasks. Tasks are dealt
+ * round-robin onto one queue per worker before run is called. Each worker
+ * takes tasks from the back of its own queue and, once that is empty, steals
+ * from the front of the other queues so slow inputs do not leave threads idle.
+ *
+ *******************************************************************************/
+class ThreadPool
+{
+    public:
+        /**
+         * A unit of work. It is passed the index of the worker
+         * running it so callers can keep per-worker state.
+         */
+        typedef std::function<void(unsigned)> Task;
+
+    private:
+        /**
+         * Tasks owned by one worker
+         */
+        struct WorkQueue
+        {
+            std::mutex mutex; /**< Guards tasks */
+            std::deque<Task> tasks; /**< Tasks waiting to run */
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues; /**< One queue per worker */
+        size_t nextQueue = 0; /**< Queue the next submitted task is dealt to */
+
+        /**
+         * Takes a task from the back of a worker's own queue or
+         * steals one from the front of another worker's queue.
+         * Returns false once every queue is empty.
+         * @param worker index of the calling worker
+         * @param task Task to fill
+         * @return bool
+         */
+        bool takeTask(unsigned worker, Task &task)
+        {
+            {
+                WorkQueue &own = *this->queues[worker];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if(!own.tasks.empty())
+                {
+                    task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+            for(size_t i = 1; i < this->queues.size(); i++)
+            {
+                WorkQueue &victim = *this->queues[(worker + i) % this->queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if(!victim.tasks.empty())
+                {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Runs tasks on one worker until none are left
+         * @param worker index of the worker
+         * @return void
+         */
+        void work(unsigned worker)
+        {
+            Task task;
+            while(this->takeTask(worker, task))
+            {
+                task(worker);
+            }
+        }
+
+    public:
+        /**
+         * Constructor that takes the number of worker threads.
+         * A count of 0 is treated as 1.
+         * @param threadCount unsigned
+         */
+        ThreadPool(unsigned threadCount)
+        {
+            if(threadCount == 0){threadCount = 1;}
+            for(unsigned i = 0; i < threadCount; i++)
+            {
+                this->queues.push_back(std::make_unique<WorkQueue>());
+            }
+        }
+
+        /**
+         * Queues a task. Tasks must be submitted before run.
+         * @param task Task
+         * @return void
+         */
+        void submit(Task task)
+        {
+            WorkQueue &queue = *this->queues[this->nextQueue];
+            this->nextQueue = (this->nextQueue + 1) % this->queues.size();
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+
+        /**
+         * Runs every queued task and returns once all have
+         * finished. The calling thread acts as worker 0.
+         * @return void
+         */
+        void run()
+        {
+            std::vector<std::thread> threads;
+            for(unsigned i = 1; i < this->queues.size(); i++)
+            {
+                threads.emplace_back(&ThreadPool::work, this, i);
+            }
+            this->work(0);
+            for(std::thread &t : threads)
+            {
+                t.join();
+            }
+        }
+
+        /**
+         * Getter
+         * Retrieves the number of workers
+         * @return unsigned
+         */
+        unsigned getThreadCount(){return this->queues.size();}
+
+        /**
+         * Converts a -j argument to a thread count. "auto"
+         * uses the number of hardware threads. Returns 0 if
+         * the argument is not a positive number.
+         * @param argument string
+         * @return unsigned
+         */
+        static unsigned parseThreadCount(const std::string &argument)
+        {
+            if(argument == "auto")
+            {
+                unsigned count = std::thread::hardware_concurrency();
+                return count > 0 ? count : 1;
+            }
+            if(argument.empty() || argument.find_first_not_of("0123456789") != std::string::npos || argument.size() > 4)
+            {
+                return 0;
+            }
+            return std::stoul(argument);
+        }
+};
+#endif
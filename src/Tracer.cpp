@@ -0,0 +1 @@
+#include "Tracer.h"
\ No newline at end of file
@@ -0,0 +1,218 @@
+#ifndef TRACER_H
+#define TRACER_H
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+/*******************************************************************************
+ * Tracer
+ *
+ * Records timed spans of a run, such as parsing a file or rendering one
+ * method, and reports them as a per-span summary (--stats) or as a Chrome
+ * trace-event file (--trace) that chrome://tracing and Perfetto can open.
+ * Each thread records into a TraceBuffer of its own, so recording takes no
+ * lock; the buffers are only read once the run is over.
+ *
+ *******************************************************************************/
+
+/**
+ * One finished span
+ */
+struct TraceEvent
+{
+    std::string name; /**< What was timed, e.g. a method or input file name */
+    const char *category; /**< Kind of span: file, phase or emit */
+    int64_t start; /**< Microseconds from the start of the trace */
+    int64_t duration; /**< Length of the span in microseconds */
+};
+
+/**
+ * Spans recorded by one thread
+ */
+class TraceBuffer
+{
+    private:
+        std::vector<TraceEvent> events; /**< Spans in the order they ended */
+        std::chrono::steady_clock::time_point origin; /**< Start of the trace */
+        unsigned thread; /**< Thread id written to the trace */
+
+    public:
+        /**
+         * Constructor that takes the start of the trace and
+         * the id of the thread recording into the buffer
+         * @param origin steady_clock time_point
+         * @param thread unsigned
+         */
+        TraceBuffer(std::chrono::steady_clock::time_point origin, unsigned thread) : origin(origin), thread(thread) {}
+
+        /**
+         * Retrieves the current time in microseconds from the
+         * start of the trace, to be passed to add as the start
+         * of a span
+         * @return int64_t
+         */
+        int64_t now() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - this->origin).count();
+        }
+
+        /**
+         * Records a span that started at start and ends now
+         * @param name string_view
+         * @param category string literal
+         * @param start int64_t from now
+         * @return void
+         */
+        void add(std::string_view name, const char *category, int64_t start)
+        {
+            this->events.push_back({std::string(name), category, start, this->now() - start});
+        }
+
+        /**
+         * Getter
+         * Retrieves the recorded spans
+         * @return vector of TraceEvent
+         */
+        const std::vector<TraceEvent> &getEvents() const {return this->events;}
+
+        /**
+         * Getter
+         * Retrieves the thread id of the buffer
+         * @return unsigned
+         */
+        unsigned getThread() const {return this->thread;}
+};
+
+class Tracer
+{
+    private:
+        std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now(); /**< Start of the trace */
+        std::vector<std::unique_ptr<TraceBuffer>> buffers; /**< One buffer per recording thread */
+        std::mutex mutex; /**< Guards buffers while threads are handed theirs */
+
+        /**
+         * Writes text as the contents of a JSON string,
+         * escaping quotes, backslashes and control characters
+         * @param out ostream
+         * @param text string_view
+         * @return void
+         */
+        static void writeJsonString(std::ostream &out, std::string_view text)
+        {
+            for(char c : text)
+            {
+                if(c == '"' || c == '\\')
+                {
+                    out << '\\' << c;
+                }
+                else if(static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out << escaped;
+                }
+                else
+                {
+                    out << c;
+                }
+            }
+        }
+
+    public:
+        /**
+         * Creates the buffer a thread records its spans into.
+         * The buffer belongs to the tracer and lives as long
+         * as it does.
+         * @return TraceBuffer
+         */
+        TraceBuffer *createBuffer()
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->buffers.push_back(std::make_unique<TraceBuffer>(this->origin, this->buffers.size() + 1));
+            return this->buffers.back().get();
+        }
+
+        /**
+         * Writes every span as a complete ("X") event of the
+         * Chrome trace-event format. Must not be called while
+         * threads are still recording. Returns false if the
+         * file could not be written.
+         * @param fileName string
+         * @return bool
+         */
+        bool write(const std::string &fileName)
+        {
+            std::ofstream out(fileName, std::ios::binary);
+            out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+            bool first = true;
+            for(const std::unique_ptr<TraceBuffer> &buffer : this->buffers)
+            {
+                for(const TraceEvent &e : buffer->getEvents())
+                {
+                    out << (first ? "" : ",\n") << "{\"name\": \"";
+                    writeJsonString(out, e.name);
+                    out << "\", \"cat\": \"" << e.category << "\", \"ph\": \"X\", \"ts\": " << e.start
+                        << ", \"dur\": " << e.duration << ", \"pid\": 1, \"tid\": " << buffer->getThread() << "}";
+                    first = false;
+                }
+            }
+            out << "\n]}\n";
+            return static_cast<bool>(out);
+        }
+
+        /**
+         * Prints the number, total, mean and longest duration
+         * of the spans of each name, longest total first. File
+         * spans are summed up under "file". Must not be called
+         * while threads are still recording.
+         * @param os ostream
+         * @return void
+         */
+        void printStats(std::ostream &os)
+        {
+            struct Stat
+            {
+                size_t count = 0;
+                int64_t total = 0;
+                int64_t longest = 0;
+            };
+            std::map<std::string, Stat> stats;
+            int64_t files = 0;
+            for(const std::unique_ptr<TraceBuffer> &buffer : this->buffers)
+            {
+                for(const TraceEvent &e : buffer->getEvents())
+                {
+                    bool isFile = std::string_view(e.category) == "file";
+                    Stat &s = stats[isFile ? std::string("file") : e.name];
+                    s.count++;
+                    s.total += e.duration;
+                    s.longest = std::max(s.longest, e.duration);
+                    if(isFile){files += e.duration;}
+                }
+            }
+            std::vector<std::pair<std::string, Stat>> sorted(stats.begin(), stats.end());
+            std::stable_sort(sorted.begin(), sorted.end(),
+                [](const auto &a, const auto &b){return a.second.total > b.second.total;});
+            char line[160];
+            os << "\nStats:\n";
+            std::snprintf(line, sizeof(line), "  %-20s %10s %12s %10s %10s %7s\n",
+                          "span", "count", "total ms", "mean us", "max us", "% file");
+            os << line;
+            for(const auto &[name, s] : sorted)
+            {
+                std::snprintf(line, sizeof(line), "  %-20s %10zu %12.3f %10.1f %10lld %7.1f\n",
+                              name.c_str(), s.count, s.total / 1000.0, (double)s.total / s.count,
+                              (long long)s.longest, files > 0 ? 100.0 * s.total / files : 0.0);
+                os << line;
+            }
+        }
+};
+#endif
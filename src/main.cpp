@@ -10,20 +10,34 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
-#include <regex>
 #include "PHPBuilder.h"
+#include "PHPParser.h"
+#include "BatchGenerator.h"
+#include "DDLParser.h"
+#include "SQLiteSchema.h"
+#include "FileWatcher.h"
+#include "MappedFile.h"
+#include "Tracer.h"
 
 int handleArguments(int argc, char *argv[], std::string &fileName);
+bool isBatchMode(std::vector<std::string> &arguments);
+int handleBatch(std::vector<std::string> &arguments, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet);
+int handleSchema(std::vector<std::string> &arguments, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet);
+int handleDatabase(std::vector<std::string> &arguments, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet);
+bool getOutputDirectory(std::vector<std::string> &arguments, std::string &outputDirectory);
+BatchResult generateModel(PHPBuilder &php, const std::string &input, GenerationCache &cache, bool force, bool quiet, TraceBuffer *trace);
+PHPBuilderOptions getBuilderOptions(std::vector<std::string> &arguments);
+bool loadTemplates(std::vector<std::string> &arguments, PHPTemplateSet &templates, bool &loaded);
+bool checkTraceArguments(std::vector<std::string> &arguments, bool &tracing);
+bool reportTrace(Tracer &tracer, std::vector<std::string> &arguments);
+int watchDirectories(BatchGenerator &batch, std::vector<std::string> &directories, bool recursive, unsigned threadCount, int debounce);
 bool validateFileType(std::string &fileName);
 void checkForInputFile(std::string &fileName, int &errorCode, std::vector<std::string> &arguments);
 bool flagExists(std::string flag, std::vector<std::string> arguments);
 std::string getFlagArgument(std::string flag, std::vector<std::string> arguments);
-void handleFile(std::string fileName);
+int handleFile(std::string fileName, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet);
 std::string stringToLower(std::string str);
-PHPBuilder parseFile(std::ifstream &input);
-std::string findField(std::string line);
-std::string findClass(std::string line);
-std::string findTableName(std::string line);
+size_t parseFile(const MappedFile &input, std::string fileName, TraceBuffer *trace, bool quiet, size_t &diagnostics, const PHPParser::ModelCallback &onModel);
 
 /**
  * A vector of strings with extensions of supported input file types
@@ -37,7 +51,16 @@ std::vector<std::string> SupportedFileTypes = { ".php", ".PHP" };
  * Main function that handles provided arguments
  * with the handleArguments function, then creates
  * a php class file with CRUD methods using the
- * handleFile function. 
+ * handleFile function. When a directory or list
+ * file is provided every input is generated in
+ * this process with handleBatch instead, a --ddl
+ * schema with handleSchema and a -s SQLite database
+ * with handleDatabase. Templates
+ * given with -t are loaded once for either mode, and
+ * the options for optional generated code are read
+ * once and passed to both. With --stats or --trace
+ * the run is recorded by a Tracer and reported once
+ * it is over, and --quiet leaves out progress output.
  * @param argc integer for total number of arguments
  * @param argv a character array of arguments
  * @return int
@@ -45,11 +68,43 @@ std::vector<std::string> SupportedFileTypes = { ".php", ".PHP" };
 int main(int argc, char *argv[])
 {
     std::string fileName; 
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    PHPTemplateSet templates;
+    bool templatesLoaded = false;
+    if(!loadTemplates(arguments, templates, templatesLoaded))
+    {
+        return 1;
+    }
+    PHPBuilderOptions options = getBuilderOptions(arguments);
+    bool tracing = false;
+    if(!checkTraceArguments(arguments, tracing))
+    {
+        return 1;
+    }
+    Tracer tracer;
+    bool quiet = flagExists("--quiet", arguments);
+    if(flagExists("--ddl", arguments))
+    {
+        return handleSchema(arguments, templatesLoaded ? &templates : nullptr, options, tracing ? &tracer : nullptr, quiet);
+    }
+    if(flagExists("-s", arguments))
+    {
+        return handleDatabase(arguments, templatesLoaded ? &templates : nullptr, options, tracing ? &tracer : nullptr, quiet);
+    }
+    if(isBatchMode(arguments))
+    {
+        return handleBatch(arguments, templatesLoaded ? &templates : nullptr, options, tracing ? &tracer : nullptr, quiet);
+    }
     //parse arguments
     int errorCode = handleArguments(argc, argv, fileName);
     if(errorCode == 0)
     {
-        handleFile(fileName);
+        int status = handleFile(fileName, templatesLoaded ? &templates : nullptr, options, tracing ? &tracer : nullptr, quiet);
+        if(tracing && !reportTrace(tracer, arguments))
+        {
+            return 1;
+        }
+        return status;
     }
     return 0;
 }
@@ -76,7 +131,7 @@ int handleArguments(int argc, char *argv[], std::string &fileName)
     }
     else
     {
-        std::cout << "PHPClassBuilder command requires a -l flag with input file name. \n Program will now exit. \n";
+        std::cout << "PHPClassBuilder command requires a -l flag with input file name, a -d flag with an input directory, an @listfile, a --ddl schema or a -s database. \n Program will now exit. \n";
         errorCode = 1;    
     }
     return errorCode; 
@@ -125,136 +180,127 @@ std::string stringToLower(std::string str)
 }
 
 /**
- * Builds a PHP class file by parsing an input file.
- * 
- * This function parses the file line by line and retrieves
- * the class name with the findClass function, and the tableName
- * using the findTablename function and the fields using the 
- * findField function. The className, fields, and tableName were 
- * used to create a PHPBuilder object. 
- * 
- * @param input ifstream 
- * @return PHPBuilder
- */
-PHPBuilder parseFile(std::ifstream &input)
-{
-    std::vector<std::string> fields;
-    std::string className; 
-    std::string tableName;
-    std::string line; 
-    std::string f;
-    int i = 1; 
-    for(std::string line; std::getline(input, line); )
-    {
-        if(findClass(line) != ""){
-            className = findClass(line);
-        }; 
-        f = findField(line);
-        if(f != ""){fields.push_back(f);}
-        if(findTableName(line) != ""){
-            tableName = findTableName(line);
-        }; 
-        i++; 
-    }
-    std::cout << "Class Name: "<< className << "\n";
-    std::cout << "Table name: " << tableName << "\n";
-    bool first = true; 
-    for(std::string field : fields) 
-    {
-        if(!first){std::cout << ", ";}
-        std::cout << field;
-        first = false; 
-    }
-    std::cout << "\n"; 
-    PHPBuilder php = PHPBuilder(className, fields, tableName);
-    return php;
-}
-
-/**
- * Finds fields in each line of input file
- * 
- * Uses a regular expression to retrieve all
- * public properties in a PHP class 
- * 
- * @param line string 
- * @return string
- */
-std::string findField(std::string line)
-{
-    std::regex rgx("public \\$(.*);");
-    std::smatch matches;
-    if(std::regex_search(line, matches, rgx))
-    {
-        return matches[1]; 
-    }
-    return ""; 
-}
-
-/**
- * Finds the class name in an input php file
+ * Builds PHP class files by parsing an input file.
  * 
- * Uses a regular expression to retrieve the
- * name of the class
+ * Tokenizes the mapped file in place in a single pass with
+ * PHPParser, which retrieves the class name, the public
+ * properties used as fields and the value of the table_name
+ * property of every class in the file. As each class ends,
+ * the problems found in it are printed with the line and
+ * column they were found on, followed by the class unless
+ * quiet is set, and the class is handed to onModel. The
+ * model points into the mapping and is only valid during
+ * the call. Returns the number of classes found and adds
+ * the number of problems printed to diagnostics.
  * 
- * @param line string 
- * @return string
+ * @param input MappedFile 
+ * @param fileName string used to label diagnostics
+ * @param trace TraceBuffer the parse is recorded into, or null
+ * @param quiet bool
+ * @param diagnostics size_t counting the problems found
+ * @param onModel ModelCallback receiving each class
+ * @return size_t
  */
-std::string findClass(std::string line)
+size_t parseFile(const MappedFile &input, std::string fileName, TraceBuffer *trace, bool quiet, size_t &diagnostics, const PHPParser::ModelCallback &onModel)
 {
-    std::regex rgx("Class (.*)\\{");
-    std::smatch matches;
-    if(std::regex_search(line, matches, rgx))
+    PHPParser parser;
+    parser.setTrace(trace);
+    PHPBuilder builder;
+    auto printDiagnostics = [&]()
     {
-        return matches[1]; 
-    }
-    return ""; 
-}
-
-/**
- * Finds the name of the table an input php file
- * 
- * Uses a regular expression to retrieve the
- * name of the table identified with the table_name
- * property
- * 
- * @param line string 
- * @return string
- */
-std::string findTableName(std::string line)
-{
-    std::regex rgx("private \\$table_name = \"(.*)\";");
-    std::smatch matches;
-    if(std::regex_search(line, matches, rgx))
+        for(const PHPDiagnostic &d : parser.getDiagnostics())
+        {
+            std::cout << fileName << ":" << d.line << ":" << d.column << ": " << d.message << "\n";
+        }
+        diagnostics += parser.getDiagnostics().size();
+    };
+    parser.parse(input.view(), builder, [&](PHPBuilder &php)
     {
-        return matches[1]; 
-    }
-    return ""; 
+        printDiagnostics();
+        if(!quiet)
+        {
+            std::cout << "Class Name: "<< php.getClassName() << "\n";
+            std::cout << "Table name: " << php.getTableName() << "\n";
+            bool first = true; 
+            for(std::string_view field : php.getFields()) 
+            {
+                if(!first){std::cout << ", ";}
+                std::cout << field;
+                first = false; 
+            }
+            std::cout << "\n"; 
+        }
+        onModel(php);
+    });
+    printDiagnostics();
+    return parser.getClassCount();
 }
 
 /**
  * Loads the input file, parses the file and builds
- * the new PHP Class File
+ * the new PHP Class Files
  * 
- * Creates an input file handle with the fileName. A
- * PHPBuilder object is created using parseFile and then
- * a PHP Class File is built using the createClassFile
- * method. 
+ * Maps the input file into memory. parseFile reads
+ * the classes of the file and, as each one ends, a
+ * PHP Class File is built for it using the createClassFile
+ * method, so a file bundling many classes gets one
+ * output per class. With a tracer the whole file, its parse and
+ * each part of the classes are recorded as spans. Quiet
+ * only prints diagnostics and errors. Returns 1 if the
+ * file could not be read, held no class, had problems
+ * or a class could not be written.
  * 
  * @param fileName string 
- * @return void
+ * @param templates PHPTemplateSet replacing built-in methods, or null
+ * @param options PHPBuilderOptions for optional generated code
+ * @param tracer Tracer recording the run, or null
+ * @param quiet bool
+ * @return int
  */
-void handleFile(std::string fileName)
+int handleFile(std::string fileName, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet)
 {
+    TraceBuffer *trace = tracer != nullptr ? tracer->createBuffer() : nullptr;
+    int64_t start = trace != nullptr ? trace->now() : 0;
     //load file
-    std::ifstream input(fileName);
-    //read file
-    PHPBuilder phpbuilder = parseFile(input);
-    std::cout << "\n\n";
-    std::cout << "Creating PHP File \n";
-    std::cout << "\n";
-    phpbuilder.createClassFile();
-    input.close(); 
-    std::cout << phpbuilder.getFileName() << " has been created.\n";
+    MappedFile input(fileName);
+    if(!input.isOpen())
+    {
+        std::cout << "Error: " << fileName << " could not be opened.\n";
+        return 1;
+    }
+    //read file, writing each class as it ends
+    size_t diagnostics = 0;
+    bool failed = false;
+    size_t classes = parseFile(input, fileName, trace, quiet, diagnostics, [&](PHPBuilder &phpbuilder)
+    {
+        if(!quiet)
+        {
+            std::cout << "\n\n";
+            std::cout << "Creating PHP File \n";
+            std::cout << "\n";
+        }
+        phpbuilder.setLog(quiet ? nullptr : &std::cout);
+        phpbuilder.setTrace(trace);
+        phpbuilder.setTemplates(templates);
+        phpbuilder.setOptions(options);
+        if(!phpbuilder.createClassFile())
+        {
+            std::cout << "Error: " << phpbuilder.getFileName() << " could not be written.\n";
+            failed = true;
+            return;
+        }
+        if(!quiet)
+        {
+            std::cout << phpbuilder.getFileName() << " has been created.\n";
+        }
+    });
+    if(trace != nullptr){trace->add(fileName, "file", start);}
+    if(classes == 0)
+    {
+        std::cout << "Error: no class was found in " << fileName << ", nothing was written.\n";
+        return 1;
+    }
+    return failed || diagnostics > 0 ? 1 : 0;
 }
 
 /**
@@ -292,7 +338,7 @@ std::string getFlagArgument(std::string flag, std::vector<std::string> arguments
     int i = 0;
     for(std::string f : arguments)
     {
-        if(f == flag)
+        if(f == flag && i + 1 < (int)arguments.size())
         {
             return arguments[i+1];
         }
@@ -344,7 +390,557 @@ void checkForInputFile(std::string &fileName, int &errorCode, std::vector<std::s
     }
     else
     {
-        std::cout << "The -l parameter with an input file name is required. Program will now exit. \n";
+        std::cout << "The -l parameter with an input file name, or a -d directory, @listfile, --ddl schema or -s database, is required. Program will now exit. \n";
         errorCode = 1; 
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Loads the templates in the -t directory if the
+ * flag is given. Each template is compiled once here
+ * and then rendered for every generated class. Sets
+ * loaded to true if templates were loaded. Returns
+ * false if the directory or a template is invalid.
+ * @param arguments vector of strings 
+ * @param templates PHPTemplateSet to load into
+ * @param loaded bool 
+ * @return bool
+ */
+bool loadTemplates(std::vector<std::string> &arguments, PHPTemplateSet &templates, bool &loaded)
+{
+    loaded = false;
+    if(!flagExists("-t", arguments))
+    {
+        return true;
+    }
+    std::string directory = getFlagArgument("-t", arguments);
+    if(directory == "-1")
+    {
+        std::cout << "The -t parameter requires a template directory. Program will now exit. \n";
+        return false;
+    }
+    std::string error;
+    if(!templates.load(directory, error))
+    {
+        std::cout << "Error: " << error << "\n";
+        return false;
+    }
+    loaded = true;
+    return true;
+}
+
+/**
+ * Checks the --trace flag has a file name and sets
+ * tracing to true if --trace or --stats is given.
+ * Returns false if the file name is missing.
+ * @param arguments vector of strings 
+ * @param tracing bool 
+ * @return bool
+ */
+bool checkTraceArguments(std::vector<std::string> &arguments, bool &tracing)
+{
+    tracing = flagExists("--stats", arguments);
+    if(flagExists("--trace", arguments))
+    {
+        if(getFlagArgument("--trace", arguments) == "-1")
+        {
+            std::cout << "The --trace parameter requires an output file name. Program will now exit. \n";
+            return false;
+        }
+        tracing = true;
+    }
+    return true;
+}
+
+/**
+ * Prints the time spent in each kind of span when
+ * --stats is given and writes every span to the
+ * --trace file in the Chrome trace-event format.
+ * Returns false if the trace file could not be
+ * written.
+ * @param tracer Tracer that recorded the run
+ * @param arguments vector of strings 
+ * @return bool
+ */
+bool reportTrace(Tracer &tracer, std::vector<std::string> &arguments)
+{
+    if(flagExists("--stats", arguments))
+    {
+        tracer.printStats(std::cout);
+    }
+    if(flagExists("--trace", arguments))
+    {
+        std::string traceFile = getFlagArgument("--trace", arguments);
+        if(!tracer.write(traceFile))
+        {
+            std::cout << "Error: trace file " << traceFile << " could not be written.\n";
+            return false;
+        }
+        std::cout << "Trace written to " << traceFile << "\n";
+    }
+    return true;
+}
+
+/**
+ * Reads the flags that switch on optional parts of
+ * the generated classes: --stmt-cache for reusing
+ * prepared statements and --approx-count for the
+ * estimated and cached counts.
+ * @param arguments vector of strings 
+ * @return PHPBuilderOptions
+ */
+PHPBuilderOptions getBuilderOptions(std::vector<std::string> &arguments)
+{
+    PHPBuilderOptions options;
+    options.statementCache = flagExists("--stmt-cache", arguments);
+    options.approxCount = flagExists("--approx-count", arguments);
+    return options;
+}
+
+/**
+ * Function that checks if the arguments ask for
+ * batch generation. Batch mode is used when no -l
+ * flag is given and either a -d directory or an
+ * @listfile argument is provided. 
+ * @param arguments vector of strings 
+ * @return bool
+ */
+bool isBatchMode(std::vector<std::string> &arguments)
+{
+    if(flagExists("-l", arguments))
+    {
+        return false;
+    }
+    if(flagExists("-d", arguments))
+    {
+        return true;
+    }
+    for(std::string a : arguments)
+    {
+        if(a.size() > 1 && a[0] == '@')
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Generates every input found in a -d directory
+ * (searched recursively with -r) and in @listfile
+ * arguments in a single process. Outputs are written
+ * below the -o directory, or the current directory,
+ * mirroring the layout of the inputs. Inputs that
+ * have not changed since the last run are skipped
+ * unless --force is given. Files are
+ * generated on the number of threads given with -j,
+ * either a count or auto for one per hardware thread.
+ * A summary of every file is printed at the end, of
+ * only the failed ones with --quiet, followed by the
+ * --stats and --trace report of the run if a tracer
+ * is given. With --watch the -d directories are then watched
+ * and changed files regenerated until interrupted,
+ * coalescing saves made within --debounce milliseconds.
+ * Returns 1 if any input could not be found or generated
+ * or the parser reported problems in one.
+ * @param arguments vector of strings 
+ * @param templates PHPTemplateSet replacing built-in methods, or null
+ * @param options PHPBuilderOptions for optional generated code
+ * @param tracer Tracer recording the first run, or null
+ * @param quiet bool
+ * @return int
+ */
+int handleBatch(std::vector<std::string> &arguments, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet)
+{
+    std::string outputDirectory = ".";
+    if(!getOutputDirectory(arguments, outputDirectory))
+    {
+        return 1;
+    }
+    unsigned threadCount = 1;
+    if(flagExists("-j", arguments))
+    {
+        threadCount = ThreadPool::parseThreadCount(getFlagArgument("-j", arguments));
+        if(threadCount == 0)
+        {
+            std::cout << "The -j parameter requires a number of threads or auto. Program will now exit. \n";
+            return 1;
+        }
+    }
+    BatchGenerator batch(outputDirectory);
+    batch.setTemplates(templates);
+    batch.setOptions(options);
+    batch.setTracer(tracer);
+    batch.setQuiet(quiet);
+    batch.enableCache(flagExists("--force", arguments));
+    bool recursive = flagExists("-r", arguments);
+    std::vector<std::string> directories;
+    for(size_t i = 0; i < arguments.size(); i++)
+    {
+        if(arguments[i] == "-d")
+        {
+            if(i + 1 >= arguments.size())
+            {
+                std::cout << "The -d parameter requires an input directory. Program will now exit. \n";
+                return 1;
+            }
+            if(!batch.addDirectory(arguments[i + 1], recursive))
+            {
+                std::cout << "Error: " << arguments[i + 1] << " is not a readable directory.\n";
+                return 1;
+            }
+            directories.push_back(arguments[i + 1]);
+            i++;
+        }
+        else if(arguments[i].size() > 1 && arguments[i][0] == '@')
+        {
+            if(!batch.addListFile(arguments[i].substr(1)))
+            {
+                std::cout << "Error: list file " << arguments[i].substr(1) << " could not be read.\n";
+                return 1;
+            }
+        }
+    }
+    if(!quiet)
+    {
+        std::cout << "Generating " << batch.getJobCount() << " PHP files on " << threadCount << " threads \n";
+    }
+    batch.run(threadCount);
+    batch.printSummary(std::cout);
+    if(tracer != nullptr)
+    {
+        if(!reportTrace(*tracer, arguments))
+        {
+            return 1;
+        }
+        //the report covers the first run, later ones are not recorded
+        batch.setTracer(nullptr);
+    }
+    if(flagExists("--watch", arguments))
+    {
+        int debounce = 10;
+        if(flagExists("--debounce", arguments))
+        {
+            std::string value = getFlagArgument("--debounce", arguments);
+            if(value.empty() || value.size() > 5 || value.find_first_not_of("0123456789") != std::string::npos)
+            {
+                std::cout << "The --debounce parameter requires a number of milliseconds. Program will now exit. \n";
+                return 1;
+            }
+            debounce = std::stoi(value);
+        }
+        return watchDirectories(batch, directories, recursive, threadCount, debounce);
+    }
+    return batch.getFailureCount() > 0 || batch.getDiagnosticCount() > 0 ? 1 : 0;
+}
+
+/**
+ * Reads the -o output directory into outputDirectory,
+ * which is left unchanged without the flag. Returns
+ * false if the flag has no directory.
+ * @param arguments vector of strings 
+ * @param outputDirectory string 
+ * @return bool
+ */
+bool getOutputDirectory(std::vector<std::string> &arguments, std::string &outputDirectory)
+{
+    if(flagExists("-o", arguments))
+    {
+        outputDirectory = getFlagArgument("-o", arguments);
+        if(outputDirectory == "-1")
+        {
+            std::cout << "The -o parameter requires an output directory. Program will now exit. \n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Generates the class of a model read from a --ddl
+ * schema or a -s database, unless the cache reports
+ * its output as up to date and force is not set, and
+ * prints its outcome. Only failures are printed when
+ * quiet. The generation is recorded as a span named
+ * after the table if trace is set.
+ * @param php PHPBuilder loaded with the model
+ * @param input string naming the model in the cache
+ * @param cache GenerationCache of the output directory
+ * @param force bool
+ * @param quiet bool
+ * @param trace TraceBuffer, or null
+ * @return BatchResult
+ */
+BatchResult generateModel(PHPBuilder &php, const std::string &input, GenerationCache &cache, bool force, bool quiet, TraceBuffer *trace)
+{
+    int64_t start = trace != nullptr ? trace->now() : 0;
+    BatchResult result = {input, php.getFileName(), false, false, "", 0};
+    uint64_t hash = php.getModelHash();
+    if(!force && cache.isUpToDate(input, hash, php.getFileName()))
+    {
+        result.success = true;
+        result.skipped = true;
+        result.message = "unchanged";
+    }
+    else if(php.createClassFile())
+    {
+        cache.record(input, hash, php.getFileName());
+        result.success = true;
+        result.message = std::to_string(php.getFields().size()) + " fields";
+    }
+    if(trace != nullptr){trace->add(php.getTableName(), "file", start);}
+    if(!result.success)
+    {
+        std::cout << "  FAIL  " << php.getTableName() << ": " << php.getFileName() << " could not be written\n";
+    }
+    else if(!quiet)
+    {
+        std::cout << (result.skipped ? "  SKIP  " : "  OK    ") << php.getTableName() << " -> "
+                  << php.getFileName() << " (" << result.message << ")\n";
+    }
+    return result;
+}
+
+/**
+ * Generates a class for every CREATE TABLE statement
+ * of the --ddl schema, such as a mysqldump --no-data
+ * file. The schema is streamed through a DDLParser and
+ * each table is generated as soon as its statement has
+ * been read, so no stub files are written and memory
+ * does not grow with the size of the schema. Classes
+ * are named after their tables and written to the -o
+ * directory, or the current directory. Tables whose
+ * model has not changed since the last run are
+ * skipped unless --force is given. One line per table
+ * is printed, only for failures with --quiet, followed
+ * by the totals and the --stats and --trace report.
+ * Returns 1 if the schema could not be read, the parser
+ * reported problems in it or a class could not be
+ * written.
+ * @param arguments vector of strings 
+ * @param templates PHPTemplateSet replacing built-in methods, or null
+ * @param options PHPBuilderOptions for optional generated code
+ * @param tracer Tracer recording the run, or null
+ * @param quiet bool
+ * @return int
+ */
+int handleSchema(std::vector<std::string> &arguments, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet)
+{
+    std::string schema = getFlagArgument("--ddl", arguments);
+    if(schema == "-1")
+    {
+        std::cout << "The --ddl parameter requires a schema file. Program will now exit. \n";
+        return 1;
+    }
+    std::string outputDirectory = ".";
+    if(!getOutputDirectory(arguments, outputDirectory))
+    {
+        return 1;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(outputDirectory, error);
+    GenerationCache cache(outputDirectory);
+    bool force = flagExists("--force", arguments);
+    TraceBuffer *trace = tracer != nullptr ? tracer->createBuffer() : nullptr;
+    DDLParser parser;
+    parser.setTrace(trace);
+    PHPBuilder builder;
+    builder.setOutputDirectory(outputDirectory);
+    builder.setLog(nullptr);
+    builder.setTrace(trace);
+    builder.setTemplates(templates);
+    builder.setOptions(options);
+    size_t unchanged = 0;
+    size_t failed = 0;
+    size_t diagnostics = 0;
+    auto printDiagnostics = [&]()
+    {
+        for(const PHPDiagnostic &d : parser.getDiagnostics())
+        {
+            std::cout << schema << ":" << d.line << ":" << d.column << ": " << d.message << "\n";
+        }
+        diagnostics += parser.getDiagnostics().size();
+    };
+    bool opened = parser.parseFile(schema, builder, [&](PHPBuilder &php)
+    {
+        printDiagnostics();
+        //one manifest entry per table of the schema
+        BatchResult r = generateModel(php, schema + "#" + std::string(php.getTableName()), cache, force, quiet, trace);
+        unchanged += r.skipped;
+        failed += !r.success;
+    });
+    if(!opened)
+    {
+        std::cout << "Error: " << schema << " could not be read.\n";
+        return 1;
+    }
+    printDiagnostics();
+    if(!cache.save())
+    {
+        std::cout << "Warning: the cache manifest could not be written.\n";
+    }
+    std::cout << parser.getTableCount() << " tables, " << parser.getTableCount() - unchanged - failed << " generated, "
+              << unchanged << " unchanged, " << failed << " failed.\n";
+    if(tracer != nullptr && !reportTrace(*tracer, arguments))
+    {
+        return 1;
+    }
+    return failed > 0 || diagnostics > 0 ? 1 : 0;
+}
+
+/**
+ * Generates a class for every table of the -s SQLite
+ * database in one pass, from the columns, primary key
+ * and indexes SQLiteSchema reads from it. Indexes get
+ * findBy methods. Classes are named after their tables
+ * and written to the -o directory, or the current
+ * directory, skipping tables whose model has not
+ * changed since the last run unless --force is given.
+ * One line per table is printed, only for failures
+ * with --quiet, followed by the totals and the --stats
+ * and --trace report. Returns 1 if the database could
+ * not be read, this build has no SQLite support,
+ * problems were reported while reading its schema or a
+ * class could not be written.
+ * @param arguments vector of strings 
+ * @param templates PHPTemplateSet replacing built-in methods, or null
+ * @param options PHPBuilderOptions for optional generated code
+ * @param tracer Tracer recording the run, or null
+ * @param quiet bool
+ * @return int
+ */
+int handleDatabase(std::vector<std::string> &arguments, const PHPTemplateSet *templates, const PHPBuilderOptions &options, Tracer *tracer, bool quiet)
+{
+    std::string database = getFlagArgument("-s", arguments);
+    if(database == "-1")
+    {
+        std::cout << "The -s parameter requires a SQLite database file. Program will now exit. \n";
+        return 1;
+    }
+    if(!SQLiteSchema::isSupported())
+    {
+        std::cout << "Error: -s requires a build with SQLite. Install SQLite 3 and rebuild. \n";
+        return 1;
+    }
+    std::string outputDirectory = ".";
+    if(!getOutputDirectory(arguments, outputDirectory))
+    {
+        return 1;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(outputDirectory, error);
+    GenerationCache cache(outputDirectory);
+    bool force = flagExists("--force", arguments);
+    TraceBuffer *trace = tracer != nullptr ? tracer->createBuffer() : nullptr;
+    SQLiteSchema schema;
+    schema.setTrace(trace);
+    PHPBuilder builder;
+    builder.setOutputDirectory(outputDirectory);
+    builder.setLog(nullptr);
+    builder.setTrace(trace);
+    builder.setTemplates(templates);
+    builder.setOptions(options);
+    size_t unchanged = 0;
+    size_t failed = 0;
+    size_t warnings = 0;
+    auto printWarnings = [&]()
+    {
+        for(const std::string &w : schema.getWarnings())
+        {
+            std::cout << database << ": " << w << "\n";
+        }
+        warnings += schema.getWarnings().size();
+    };
+    std::string message;
+    bool loaded = schema.load(database, builder, [&](PHPBuilder &php)
+    {
+        printWarnings();
+        //one manifest entry per table of the database
+        BatchResult r = generateModel(php, database + "#" + std::string(php.getTableName()), cache, force, quiet, trace);
+        unchanged += r.skipped;
+        failed += !r.success;
+    }, message);
+    printWarnings();
+    if(!loaded)
+    {
+        std::cout << "Error: " << database << " could not be read: " << message << "\n";
+        return 1;
+    }
+    if(!cache.save())
+    {
+        std::cout << "Warning: the cache manifest could not be written.\n";
+    }
+    std::cout << schema.getTableCount() << " tables, " << schema.getTableCount() - unchanged - failed << " generated, "
+              << unchanged << " unchanged, " << failed << " failed.\n";
+    if(tracer != nullptr && !reportTrace(*tracer, arguments))
+    {
+        return 1;
+    }
+    return failed > 0 || warnings > 0 ? 1 : 0;
+}
+
+/**
+ * Watches the -d directories and regenerates each
+ * .php file that is saved in them. Saves made less
+ * than debounce milliseconds apart are coalesced
+ * and each changed file is generated
+ * once with the parsers and builders kept from the
+ * first run. The time taken to generate each file and
+ * the time from the save being seen to the output
+ * being written are printed. Runs until interrupted
+ * and returns 1 if watching is not possible.
+ * @param batch BatchGenerator used for the first run
+ * @param directories vector of strings with the -d directories
+ * @param recursive bool
+ * @param threadCount unsigned
+ * @param debounce int
+ * @return int
+ */
+int watchDirectories(BatchGenerator &batch, std::vector<std::string> &directories, bool recursive, unsigned threadCount, int debounce)
+{
+    FileWatcher watcher(debounce);
+    if(!watcher.isSupported() || directories.empty())
+    {
+        std::cout << "Error: --watch requires a -d directory and inotify (Linux).\n";
+        return 1;
+    }
+    for(std::string d : directories)
+    {
+        if(!watcher.addDirectory(d, recursive))
+        {
+            std::cout << "Error: " << d << " could not be watched.\n";
+            return 1;
+        }
+    }
+    std::cout << "\nWatching " << watcher.getDirectoryCount() << " directories. Press Ctrl+C to stop." << std::endl;
+    while(true)
+    {
+        std::vector<WatchedChange> changes = watcher.wait();
+        if(changes.empty())
+        {
+            std::cout << "Error: watching stopped unexpectedly.\n";
+            return 1;
+        }
+        batch.clearResults();
+        for(const WatchedChange &c : changes)
+        {
+            batch.addFile(c.file, c.base);
+        }
+        batch.run(threadCount);
+        auto written = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < changes.size(); i++)
+        {
+            const BatchResult &r = batch.getResults()[i];
+            double latency = std::chrono::duration<double, std::milli>(written - changes[i].seen).count();
+            if(!r.success)
+            {
+                std::cout << "FAIL  " << r.input << ": " << r.message << "\n";
+                continue;
+            }
+            std::cout << (r.skipped ? "SKIP  " : "OK    ") << r.input << " -> " << r.output
+                      << " (" << r.message << ", " << r.milliseconds << " ms to generate, "
+                      << latency << " ms from save to output)\n";
+        }
+        std::cout.flush();
+    }
+}
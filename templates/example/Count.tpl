@@ -0,0 +1,17 @@
+	/**
+	 * Retrieves the total number of records in the {{classNameLower}}
+	 * table.
+	 *
+	 * Prepares and executes a simple Select statement retrieving the
+	 * count for all rows in {{tableName}}.
+	 * @return int
+	*/
+		public function count(): int
+		{
+			$query = "SELECT COUNT(*) as count FROM {{tableName}}";
+			$stmt = $this->conn->prepare($query);
+			$stmt->execute();
+			$row = $stmt->fetch(PDO::FETCH_ASSOC);
+			return (int)$row['count'];
+		}
+
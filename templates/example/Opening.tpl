@@ -0,0 +1,9 @@
+<?php 
+	/**
+	 * Class used to handle CRUD operations related to {{classNameLower}}s. 
+	 */
+	class {{className}}
+	{
+{{#fields}}		public ${{field}};
+{{/fields}}		private $conn;
+		private $table_name = "{{tableName}}";